@@ -11,7 +11,7 @@
 # Each tool using this file must define, at a minimum, "tool_name".  This
 # variable should hold the name of the desired executable.
 #
-# In addition, the following two variables may be defined:
+# In addition, the following variables may be defined:
 #
 #   - "comma_components": a sequence of library names provided by the Comma
 #     system on which this tool depends.  For example, if you depend on
@@ -22,6 +22,8 @@
 #     is no mechanism to infer the needed components using only the contents of
 #     "comma_components", and so must be provided explicitly,
 #
+#   - "tool_ld_flags": additional linker flags for the tool.
+#
 ##----------------------------------------------------------------------------##
 
 #
@@ -58,7 +60,7 @@ endif
 #
 # Assemble all linker flags.
 #
-ld_flags = $(comma_ld_flags) $(llvm_ld_flags)
+ld_flags = $(comma_ld_flags) $(tool_ld_flags) $(llvm_ld_flags)
 
 
 $(thetool): $(prj_objects) $(comma_libnames)
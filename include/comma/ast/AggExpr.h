@@ -206,30 +206,14 @@ public:
     void getUpperValue(llvm::APInt &value) const;
     //@}
 
-    /// \name Comparison Predicates.
-    //@{
-
     /// \brief Returns true if this ComponentKey is comparable.
     ///
     /// ComponentKeys are comparable if the underlying representation is a
     /// static expression, range, discrete subtype indication.  ComponentKeys
     /// represented as Identifiers are not considered to be comparable.
-    bool isComparable() const { return !denotesIdentifier() && isStatic(); }
-
-    /// \brief Provides an ordering relation between two ComponentKey's for
-    /// which isComparable is true.
-    ///
-    /// Predicate defining a less-than relation between component keys of
-    /// unsigned type.  For use with std::stort.
-    static bool compareKeysU(const ComponentKey *X, const ComponentKey *Y);
-
-    /// \brief Provides an ordering relation between two ComponentKey's for
-    /// which isComparable is true.
     ///
-    /// Predicate defining a less-than relation between keys of signed type.
-    /// For use with std::stort.
-    static bool compareKeysS(const ComponentKey *X, const ComponentKey *Y);
-    //@}
+    /// \see KeyIntervalSet
+    bool isComparable() const { return !denotesIdentifier() && isStatic(); }
 
     // Support isa/dyn_cast.
     static bool classof(const ComponentKey *node) { return true; }
@@ -242,6 +226,102 @@ private:
     Location loc;
 };
 
+//===----------------------------------------------------------------------===//
+// KeyIntervalSet
+//
+/// \class
+///
+/// \brief Represents the indices defined by a set of comparable ComponentKeys
+/// as a sorted sequence of disjoint intervals, or runs.
+///
+/// The bounds of each key are evaluated exactly once.  Keys denoting adjacent
+/// indices are merged into a single run, so clients interested in the overall
+/// shape of an index set (its extent, or the holes to be filled by an \c
+/// others clause) work with the runs rather than with each individual key.
+///
+/// Index values are exposed as 64 bit integers holding the two's complement
+/// representation of the value.
+class KeyIntervalSet {
+
+public:
+    /// Builds an interval set over the ComponentKeys in the range [\p I, \p
+    /// E).  Each key must be comparable.  When \p isSigned is true the keys
+    /// are interpreted as signed values, otherwise as unsigned values.
+    template <class Iter>
+    KeyIntervalSet(Iter I, Iter E, bool isSigned) : isSigned(isSigned) {
+        for ( ; I != E; ++I)
+            addKey(*I);
+        build();
+    }
+
+    /// Returns true if this set is empty.
+    bool empty() const { return runs.empty(); }
+
+    /// Returns the number of disjoint runs in this set.
+    unsigned numRuns() const { return runs.size(); }
+
+    //@{
+    /// Returns the lower and upper bound of the \p i'th run.
+    uint64_t getRunLower(unsigned i) const { return decode(runs[i].lower); }
+    uint64_t getRunUpper(unsigned i) const { return decode(runs[i].upper); }
+    //@}
+
+    //@{
+    /// Returns the key defining the first and last index of this set.
+    ComponentKey *getFirstKey() const { return runs.front().first; }
+    ComponentKey *getLastKey() const { return runs.back().last; }
+    //@}
+
+    /// \brief Locates overlapping keys.
+    ///
+    /// If two keys define a common index, sets \p X and \p Y to the first such
+    /// pair (in index order) and returns true.  Otherwise returns false.
+    bool getOverlap(ComponentKey *&X, ComponentKey *&Y) const {
+        X = overlapX;
+        Y = overlapY;
+        return X != 0;
+    }
+
+    /// \brief Locates the first hole in this set.
+    ///
+    /// If this set consists of more than one run, sets \p X to the key ending
+    /// the first run and \p Y to the key starting the second and returns true.
+    /// Otherwise returns false.
+    bool getDiscontinuity(ComponentKey *&X, ComponentKey *&Y) const;
+
+private:
+    /// Key bounds are stored biased such that unsigned comparisons order
+    /// both signed and unsigned values correctly.
+    struct Interval {
+        uint64_t lower;
+        uint64_t upper;
+        ComponentKey *first;
+        ComponentKey *last;
+
+        bool operator <(const Interval &I) const { return lower < I.lower; }
+    };
+
+    typedef std::vector<Interval> IntervalVec;
+    IntervalVec runs;
+    bool isSigned;
+
+    ComponentKey *overlapX;
+    ComponentKey *overlapY;
+
+    /// Converts between the representation of a value and its biased form.
+    uint64_t encode(uint64_t value) const {
+        return isSigned ? value ^ (uint64_t(1) << 63) : value;
+    }
+    uint64_t decode(uint64_t value) const { return encode(value); }
+
+    /// Adds the given key to this set.
+    void addKey(ComponentKey *key);
+
+    /// Sorts the collected keys, detects overlaps and merges adjacent keys
+    /// into runs.
+    void build();
+};
+
 //===----------------------------------------------------------------------===//
 // ComponentKeyList
 //
@@ -252,13 +332,12 @@ class ComponentKeyList {
 
 public:
     /// Constructs a ComponentKeyList over the given set of ComponentKeys.  At
-    /// least one key must be provided.
-    static ComponentKeyList *create(ComponentKey **keys, unsigned numKeys,
+    /// least one key must be provided.  The list is allocated from the given
+    /// resource.
+    static ComponentKeyList *create(AstResource &resource,
+                                    ComponentKey **keys, unsigned numKeys,
                                     Expr *expr);
 
-    /// Deallocates a ComponentKeyList.
-    static void dispose(ComponentKeyList *CL);
-
     //@{
     /// Returns the associated expression.
     const Expr *getExpr() const { return expr; }
@@ -378,8 +457,6 @@ private:
 class AggregateExpr : public Expr {
 
 public:
-    ~AggregateExpr();
-
     /// Constructs an empty AggregateExpr.  Components of this aggregate are
     /// introduced via calls to addComponent().
     AggregateExpr(Location loc) : Expr(AST_AggregateExpr, loc), others(0) { }
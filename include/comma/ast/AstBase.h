@@ -18,6 +18,12 @@
 #include "comma/basic/IdentifierInfo.h"
 #include "llvm/Support/Casting.h"
 
+#include <cstddef>
+
+namespace llvm {
+class raw_ostream;
+} // end llvm namespace.
+
 namespace comma {
 
 //
@@ -312,7 +318,7 @@ public:
         LAST_Stmt = AST_PragmaStmt
     };
 
-    virtual ~Ast() { }
+    virtual ~Ast() { --liveCounts[kind]; }
 
     ///  Accesses the code identifying this node.
     AstKind getKind() const { return kind; }
@@ -410,6 +416,25 @@ public:
     /// Support isa and dyn_cast.
     static bool classof(const Ast *node) { return true; }
 
+    /// \name Node allocation.
+    ///
+    /// Ast nodes are allocated from the arena of an AstResource using the
+    /// placement syntax <tt>new (resource) Node(...)</tt>.  The resource runs
+    /// the destructor of every node still alive when it is destroyed, and
+    /// reclaims their storage all at once.  Deleting a node runs its
+    /// destructor early but does not release the memory it occupies.
+    //@{
+    void *operator new(size_t bytes, AstResource &resource);
+    void operator delete(void *ptr, AstResource &resource) { }
+    void operator delete(void *ptr);
+    //@}
+
+    /// Prints the number of nodes of each kind created and currently alive,
+    /// together with the memory they occupy, to the given stream.  Storage
+    /// allocated out of line by a node (operand arrays and the like) is not
+    /// included.
+    static void printStats(llvm::raw_ostream &stream);
+
 protected:
     /// Initializes an Ast node of the specified kind.
     ///
@@ -418,7 +443,10 @@ protected:
         : kind(kind),
           validFlag(true),
           deletable(true),
-          bits(0) { }
+          bits(0) {
+        ++createdCounts[kind];
+        ++liveCounts[kind];
+    }
 
     AstKind  kind      : 8;     ///< The kind of this node.
     bool     validFlag : 1;     ///< True if this node is valid.
@@ -426,6 +454,13 @@ protected:
     unsigned bits      : 23;    ///< Unused bits available to sub-classes.
 
     static const char *kindStrings[LAST_AstKind];
+
+    /// Number of nodes of each kind created and currently alive.
+    static unsigned createdCounts[LAST_AstKind];
+    static unsigned liveCounts[LAST_AstKind];
+
+    /// The size of the node class corresponding to each kind.
+    static const unsigned kindSizes[LAST_AstKind];
 };
 
 } // End comma namespace.
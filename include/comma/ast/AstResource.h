@@ -11,6 +11,17 @@
 // allocation of nodes, a single point of contact for fundamental facilities
 // like an identifier pool.
 //
+// Every Ast node, together with any storage it holds out of line, lives in an
+// arena owned by the resource.  When the resource is destroyed the destructor
+// of every node which was not deleted beforehand is run, and the arena is
+// released as a whole.
+//
+// A resource may be created as the child of another, in which case its nodes
+// may refer to those of the parent but not the other way around.  The child
+// shares the language defined nodes and uniqued types of its parent, so that
+// the nodes of a single compilation can be released before the nodes they
+// build upon.
+//
 //===----------------------------------------------------------------------===//
 
 #ifndef COMMA_AST_ASTRESOURCE_HDR_GUARD
@@ -21,6 +32,7 @@
 #include "comma/basic/PrimitiveOps.h"
 
 #include "llvm/ADT/FoldingSet.h"
+#include "llvm/Support/Allocator.h"
 
 #include <vector>
 
@@ -40,6 +52,13 @@ class AstResource {
 public:
     AstResource(IdentifierPool &idPool);
 
+    /// Creates a child of the given resource.  The child must be destroyed
+    /// before its parent.
+    explicit AstResource(AstResource &parent);
+
+    /// Destroys every node allocated from this resource which is still alive.
+    ~AstResource();
+
     IdentifierPool &getIdentifierPool() { return idPool; }
 
     // Convenience function to extract an IdentifierInfo object from the
@@ -54,6 +73,27 @@ public:
         return &idPool.getIdentifierInfo(name);
     }
 
+    /// Allocates \p bytes of node storage with the given alignment.  The
+    /// storage lives until this resource is destroyed.
+    void *allocate(size_t bytes, size_t alignment = 8) {
+        nodeBytes += bytes;
+        return nodeStorage.Allocate(bytes, alignment);
+    }
+
+    /// Allocates storage for an Ast node of the given size.  The node is
+    /// destroyed along with this resource unless it is deleted beforehand.
+    void *allocateNode(size_t bytes);
+
+    /// Notes that the node occupying the given storage has been deleted.
+    static void releaseNode(void *ptr);
+
+    /// Allocates uninitialized storage for \p count objects of type T.
+    template <class T>
+    T *allocateArray(unsigned count) {
+        nodeBytes += count * sizeof(T);
+        return nodeStorage.Allocate<T>(count);
+    }
+
     /// Returns a uniqued FunctionType.
     FunctionType *getFunctionType(Type **argTypes, unsigned numArgs,
                                   Type *returnType);
@@ -288,14 +328,36 @@ public:
     ExceptionDecl *getTheAssertionError() const { return theAssertionError; }
     //@}
 
+    /// Prints the number of nodes owned by this resource and the sizes of the
+    /// uniquing tables to the given stream.
+    void printStats(llvm::raw_ostream &stream) const;
+
 private:
     IdentifierPool &idPool;
 
+    /// The resource this one is a child of, or null.
+    AstResource *parent;
+
+    /// Arena holding all nodes and their out of line storage.
+    llvm::BumpPtrAllocator nodeStorage;
+    size_t nodeBytes;
+
+    /// Each node is preceded in the arena by a header noting whether the node
+    /// is still alive.  The header preserves the alignment of the node.
+    union NodeHeader {
+        bool live;
+        uint64_t align;
+    };
+
+    /// The headers of every node allocated from this resource.
+    std::vector<NodeHeader*> nodes;
+
     // Vectors of declaration and type nodes.
     std::vector<Decl*> decls;
     std::vector<Type*> types;
 
-    // Tables of uniqued subroutine types.
+    // Tables of uniqued subroutine types.  Types uniqued by a parent resource
+    // are not entered again.
     llvm::FoldingSet<FunctionType> functionTypes;
     llvm::FoldingSet<ProcedureType> procedureTypes;
 
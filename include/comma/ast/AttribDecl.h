@@ -42,11 +42,12 @@ public:
     }
 
 protected:
-    FunctionAttribDecl(AstKind kind, PrimaryType *prefix,
+    FunctionAttribDecl(AstKind kind, AstResource &resource,
+                       PrimaryType *prefix,
                        IdentifierInfo *name, Location loc,
                        IdentifierInfo **keywords, FunctionType *type,
                        DeclRegion *parent)
-        : FunctionDecl(kind, name, loc, keywords, type, parent),
+        : FunctionDecl(kind, resource, name, loc, keywords, type, parent),
           prefix(prefix) {
         bits = correspondingID(kind);
     }
@@ -111,10 +112,11 @@ private:
     friend class EnumerationDecl;
 
     /// Private constructor for use by the static constructor functions.
-    PosAD(DiscreteType *prefix, IdentifierInfo *name, Location loc,
+    PosAD(AstResource &resource,
+          DiscreteType *prefix, IdentifierInfo *name, Location loc,
           IdentifierInfo **keywords, FunctionType *type,
           DeclRegion *parent)
-        : FunctionAttribDecl(AST_PosAD, prefix, name, loc,
+        : FunctionAttribDecl(AST_PosAD, resource, prefix, name, loc,
                              keywords, type, parent) { }
 };
 
@@ -152,10 +154,11 @@ private:
     friend class EnumerationDecl;
 
     /// Private constructor for use by the static constructor functions.
-    ValAD(DiscreteType *prefix, IdentifierInfo *name, Location loc,
+    ValAD(AstResource &resource,
+          DiscreteType *prefix, IdentifierInfo *name, Location loc,
           IdentifierInfo **keywords, FunctionType *type,
           DeclRegion *parent)
-        : FunctionAttribDecl(AST_ValAD, prefix, name, loc,
+        : FunctionAttribDecl(AST_ValAD, resource, prefix, name, loc,
                              keywords, type, parent) { }
 };
 
@@ -168,8 +168,6 @@ private:
 class PackageDecl : public Decl, public DeclRegion {
 
 public:
-    ~PackageDecl();
-
     PackageDecl(AstResource &resource, IdentifierInfo *name, Location loc);
 
     /// Returns the AstResource object associated with this package.
@@ -482,8 +480,6 @@ public:
 class SubroutineDecl : public Decl, public DeclRegion {
 
 public:
-    virtual ~SubroutineDecl();
-
     //@{
     /// Returns the type of this declaration.
     virtual SubroutineType *getType() = 0;
@@ -677,11 +673,13 @@ public:
 protected:
     // Subroutine decls take ownership of any ParamValueDecls supplied (but not
     // the array they are passed in).
-    SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
+    SubroutineDecl(AstKind kind, AstResource &resource,
+                   IdentifierInfo *name, Location loc,
                    ParamValueDecl **params, unsigned numParams,
                    DeclRegion *parent);
 
-    SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
+    SubroutineDecl(AstKind kind, AstResource &resource,
+                   IdentifierInfo *name, Location loc,
                    IdentifierInfo **keywords, SubroutineType *type,
                    DeclRegion *parent);
 
@@ -729,10 +727,11 @@ public:
     /// arity of the supplied type, or 0 if this is a nullary procedure).  The
     /// resulting parameter decls all have default modes, and so one must set
     /// each by hand if need be afterwords.
-    ProcedureDecl(IdentifierInfo *name, Location loc,
+    ProcedureDecl(AstResource &resource, IdentifierInfo *name, Location loc,
                   IdentifierInfo **keywords, ProcedureType *type,
                   DeclRegion *parent)
-        : SubroutineDecl(AST_ProcedureDecl, name, loc, keywords, type, parent),
+        : SubroutineDecl(AST_ProcedureDecl, resource, name, loc,
+                         keywords, type, parent),
           correspondingType(type) { }
 
     ProcedureDecl(IdentifierInfo *name, Location loc,
@@ -796,10 +795,11 @@ public:
     /// arity of the supplied type, or 0 if this is a nullary function).  The
     /// resulting parameter decls all have default modes, and so one must set
     /// each by hand if need be afterwords.
-    FunctionDecl(IdentifierInfo *name, Location loc,
+    FunctionDecl(AstResource &resource, IdentifierInfo *name, Location loc,
                  IdentifierInfo **keywords, FunctionType *type,
                  DeclRegion *parent)
-        : SubroutineDecl(AST_FunctionDecl, name, loc, keywords, type, parent),
+        : SubroutineDecl(AST_FunctionDecl, resource, name, loc,
+                         keywords, type, parent),
           correspondingType(type) { }
 
     //@{
@@ -847,10 +847,11 @@ protected:
                  EnumerationType *returnType, DeclRegion *parent);
 
     // Constructor for use by FunctionAttribDecl.
-    FunctionDecl(AstKind kind, IdentifierInfo *name, Location loc,
+    FunctionDecl(AstKind kind, AstResource &resource,
+                 IdentifierInfo *name, Location loc,
                  IdentifierInfo **keywords, FunctionType *type,
                  DeclRegion *parent)
-        : SubroutineDecl(kind, name, loc, keywords, type, parent),
+        : SubroutineDecl(kind, resource, name, loc, keywords, type, parent),
           correspondingType(type) { }
 
 private:
@@ -1413,8 +1414,8 @@ public:
     ///
     /// The order in which is method is called determines the order of the
     /// associated components.
-    ComponentDecl *addComponent(IdentifierInfo *name, Location loc,
-                                Type *type);
+    ComponentDecl *addComponent(AstResource &resource, IdentifierInfo *name,
+                                Location loc, Type *type);
 
     /// Returns the number of components provided by this record.
     unsigned numComponents() const { return componentCount; }
@@ -1636,19 +1637,53 @@ public:
     // to the point of instantiation.
     PkgInstanceDecl(IdentifierInfo *name, Location loc, PackageDecl *package);
 
+    /// Releases the rewriter of an instance which was never fully
+    /// materialized.
+    ~PkgInstanceDecl();
+
     //@{
     /// Returns the package declaration defining this instance.
     PackageDecl *getDefinition() { return definition; }
     const PackageDecl *getDefinition() const { return definition; }
     //@}
 
+    /// \name Materialization.
+    ///
+    /// The declarations provided by an instance are rewritten from those of
+    /// the defining package on demand.  Each lookup of a name thru findDecls,
+    /// findDecl or containsDecl materializes every declaration bearing that
+    /// name.  Clients which iterate over the declarations of an instance must
+    /// first call materializeAll.
+    //@{
+    /// Returns true if every declaration provided by the defining package has
+    /// been materialized.
+    bool isMaterialized() const { return rewriter == 0; }
+
+    /// Materializes the declarations with the given name.
+    void materialize(IdentifierInfo *name);
+
+    /// Materializes each enumeration declaration providing a literal with the
+    /// given name.
+    void materializeLiteral(IdentifierInfo *name);
+
+    /// Materializes every declaration provided by the defining package.
+    void materializeAll();
+    //@}
+
     static bool classof(const PkgInstanceDecl *node) { return true; }
     static bool classof(const Ast *node) {
         return node->getKind() == AST_PkgInstanceDecl;
     }
 
+protected:
+    void provideDecls(IdentifierInfo *name) const;
+
 private:
     PackageDecl *definition;
+
+    /// The rewriter used to materialize declarations, or null once this
+    /// instance has been fully materialized.
+    DeclRewriter *rewriter;
 };
 
 //===----------------------------------------------------------------------===//
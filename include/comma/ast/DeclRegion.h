@@ -11,6 +11,7 @@
 
 #include "comma/ast/AstBase.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallVector.h"
 
@@ -33,6 +34,14 @@ protected:
     typedef std::vector<Decl*> DeclarationTable;
     DeclarationTable declarations;
 
+    // Each name declared in this region is mapped to the chain of
+    // declarations bearing that name, in order of addition.  The index is
+    // maintained by addDecl and removeDecl and permits lookups by name
+    // without scanning the full declaration table.
+    typedef llvm::SmallVector<Decl*, 1> DeclChain;
+    typedef llvm::DenseMap<IdentifierInfo*, DeclChain> NameIndex;
+    NameIndex nameIndex;
+
 public:
     virtual ~DeclRegion() { }
 
@@ -91,7 +100,8 @@ public:
     // generally useful/desirable.
     //
     // A PredIter is a trivial forward iterator which skips certain elements of
-    // the underlying sequence according to a supplied predicate object.
+    // the underlying sequence according to a supplied predicate object.  A
+    // null predicate accepts every element.
     //
     // Most implementations of such "filter" iterators use templates to forward
     // the predicate and underlying iterator types.  This implementation relies
@@ -108,7 +118,7 @@ public:
     class PredIter {
         friend class DeclRegion;
 
-        typedef DeclRegion::ConstDeclIter DeclIter;
+        typedef Decl *const *DeclIter;
 
         struct Predicate : public llvm::RefCountedBaseVPTR<Predicate> {
             virtual bool operator()(const Decl*) = 0;
@@ -120,7 +130,7 @@ public:
         DeclIter     end;
 
         bool predCall(const Decl *decl) {
-            return predicate->operator()(decl);
+            return !predicate || predicate->operator()(decl);
         }
 
         PredIter(Predicate *pred,
@@ -169,12 +179,14 @@ public:
 
     typedef std::pair<PredIter, PredIter> PredRange;
 
+    // Returns the range of declarations in this region with the given name,
+    // in order of addition.
     PredRange findDecls(IdentifierInfo *name) const;
 
     // Returns true if this region contains a declaration with the given name.
     bool containsDecl(IdentifierInfo *name) const {
-        PredRange range = findDecls(name);
-        return range.first != range.second;
+        provideDecls(name);
+        return nameIndex.count(name);
     }
 
     // Returns true if this region contains the given declaration.
@@ -259,6 +271,11 @@ protected:
     virtual void notifyAddDecl(Decl *decl);
     virtual void notifyRemoveDecl(Decl *decl);
 
+    // Invoked before each lookup of the given name.  Regions which provide
+    // their declarations on demand override this method to add those bearing
+    // the given name.  The default implementation does nothing.
+    virtual void provideDecls(IdentifierInfo *name) const;
+
 private:
     Ast::AstKind regionKind;
     DeclRegion *parent;
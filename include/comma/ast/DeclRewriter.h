@@ -72,10 +72,16 @@ public:
 
     /// \name Declaration rewrite methods.
     ///
-    /// The following method rewrite declaration nodes.  A new declaration node
-    /// is always returned regardless of whether any rewrite rules applied.  The
-    /// declarative region to which the new node belongs is the one supplied to
-    /// this rewritors ctor.
+    /// The following method rewrite declaration nodes.  Type declarations are
+    /// copied on write: when no rewrite rule affects a type declaration the
+    /// original node is returned and shared with the origin.  Otherwise, and
+    /// for subroutine declarations (which identify the context they are
+    /// declared in), a new declaration node is returned.  The declarative
+    /// region to which a new node belongs is the one supplied to this
+    /// rewritors ctor.
+    ///
+    /// Each declaration is rewritten at most once per rewriter.  Subsequent
+    /// requests return the memoized result.
     //@{
     TypeDecl *rewriteTypeDecl(TypeDecl *tdecl);
 
@@ -101,6 +107,10 @@ public:
     /// Rewrites the given declaration node.
     Decl *rewriteDecl(Decl *decl);
 
+    /// Returns the number of declaration nodes produced by all DeclRewriter
+    /// instances.
+    static unsigned getNumRewrittenDecls() { return numRewrittenDecls; }
+
 private:
     DeclRegion *context;
     DeclRegion *origin;
@@ -117,6 +127,9 @@ private:
     /// Returns true if the given declaration has an associated rewrite rule.
     bool hasRewrite(Decl *source) const { return findRewrite(source) != 0; }
 
+    /// Running count of the declarations produced by rewriting.
+    static unsigned numRewrittenDecls;
+
     /// \brief Adds a declaration rewrite rule from \p source to \p target.
     /// This method will assert if a rule already exists for \p source.
     void addDeclRewrite(Decl *source, Decl *target) {
@@ -124,10 +137,49 @@ private:
         declRewrites[source] = target;
     }
 
+    /// \brief Like addDeclRewrite, but notes that \p target is a new node
+    /// produced by this rewriter.
+    void addNewDecl(Decl *source, Decl *target) {
+        addDeclRewrite(source, target);
+        ++numRewrittenDecls;
+    }
+
     /// Populates the rewrite map with all declarations is \p source to the
     /// corresponding declarations in \p target.
     void mirrorRegion(DeclRegion *source, DeclRegion *target);
 
+    /// Memoized results of isAffected over type declarations.  Declarations
+    /// under analysis are provisionally considered affected, so the members of
+    /// a cycle (for example, a recursive access type) are always copied.
+    typedef llvm::DenseMap<Decl*, bool> AffectedMap;
+    AffectedMap affectedDecls;
+
+    /// \name Rewrite Predicates.
+    ///
+    /// Returns true if rewriting the given node could produce a different
+    /// node.
+    //@{
+    bool isAffected(TypeDecl *decl);
+    bool isAffected(Type *type);
+    bool isAffected(Expr *expr);
+    //@}
+
+    /// Helper for isAffected.  Computes the result for the given declaration
+    /// without consulting affectedDecls.
+    bool computeAffected(TypeDecl *decl);
+
+    /// \brief Returns the rewrite of \p decl if it can be determined without
+    /// building a new node, else null.
+    ///
+    /// If \p decl has already been rewritten the memoized result is returned.
+    /// Otherwise, if no rewrite rule affects \p decl, \p decl is recorded as
+    /// its own rewrite and returned.
+    TypeDecl *findOrShareDecl(TypeDecl *decl);
+
+    /// Returns the declaration of the given discrete or private type if it is
+    /// declared in the origin, else null.
+    TypeDecl *getOriginDecl(Type *type);
+
     Type *rewriteType(Type *type);
     AccessType *rewriteAccessType(AccessType *type);
     RecordType *rewriteRecordType(RecordType *type);
@@ -31,12 +31,14 @@ class Expr : public Ast {
 
 public:
     Expr(AstKind kind, Type *type, Location loc = Location())
-        : Ast(kind), type(type), location(loc) {
+        : Ast(kind), type(type), location(loc),
+          staticState(STATIC_UNKNOWN), staticWidth(0), staticValue(0) {
         assert(this->denotesExpr());
     }
 
     Expr(AstKind kind, Location loc = Location())
-        : Ast(kind), type(0), location(loc) {
+        : Ast(kind), type(0), location(loc),
+          staticState(STATIC_UNKNOWN), staticWidth(0), staticValue(0) {
         assert(this->denotesExpr());
     }
 
@@ -91,8 +93,20 @@ public:
     /// computed value.
     ///
     /// \return True if \p expr is static and \p result was set.  False otherwise.
+    ///
+    /// The outcome is cached on this node once it can no longer change, that
+    /// is, once this expression and all of its subexpressions have resolved
+    /// types.
     bool staticDiscreteValue(llvm::APInt &result) const;
 
+    /// \brief Variant of staticDiscreteValue used when evaluating enclosing
+    /// expressions.
+    ///
+    /// \p settled is set to false if the outcome might yet change as the
+    /// types of this expression or its subexpressions are resolved.  It is
+    /// otherwise left untouched.
+    bool staticDiscreteValue(llvm::APInt &result, bool &settled) const;
+
     /// \brief Attempts to evaluate this expression as a constant string
     /// expression.
     ///
@@ -146,6 +160,21 @@ public:
 private:
     Type *type;
     Location location;
+
+    /// \name Static evaluation cache.
+    ///
+    /// Settled static values which fit in 64 bits are held here together with
+    /// their bit width.  Wider values are recomputed on each request.
+    //@{
+    enum StaticState {
+        STATIC_UNKNOWN,         ///< Not yet evaluated, or not settled.
+        STATIC_VALUE,           ///< Static with the cached value.
+        STATIC_NONE             ///< Not a static expression.
+    };
+    mutable unsigned staticState : 2;
+    mutable unsigned staticWidth : 7;
+    mutable int64_t staticValue;
+    //@}
 };
 
 //===----------------------------------------------------------------------===//
@@ -196,23 +225,25 @@ public:
     /// The given SubroutineRef must reference a set of FunctionDecl's.  If more
     /// than one declaration is associated with the ref, then the function call
     /// is said to be ambiguous.
-    FunctionCallExpr(SubroutineRef *connective,
+    FunctionCallExpr(AstResource &resource, SubroutineRef *connective,
                      Expr **positionalArgs, unsigned numPositional,
                      KeywordSelector **keyedArgs, unsigned numKeys);
 
     /// Creates a resolved function call expression over the given function
     /// declaration.
-    FunctionCallExpr(FunctionDecl *connective, Location loc,
+    FunctionCallExpr(AstResource &resource,
+                     FunctionDecl *connective, Location loc,
                      Expr **positionalArgs, unsigned numPositional,
                      KeywordSelector **keyedArgs, unsigned numKeys);
 
     /// Create a nullary function call expression using the given SubroutineRef
     /// as connective.
-    FunctionCallExpr(SubroutineRef *connective);
+    FunctionCallExpr(AstResource &resource, SubroutineRef *connective);
 
     /// Create a nullary function call expression using the given FunctionDecl
     /// as connective.
-    FunctionCallExpr(FunctionDecl *connective, Location loc);
+    FunctionCallExpr(AstResource &resource,
+                     FunctionDecl *connective, Location loc);
 
     /// Returns the location of this function call.
     ///
@@ -282,7 +313,8 @@ private:
 class IndexedArrayExpr : public Expr {
 
 public:
-    IndexedArrayExpr(Expr *arrExpr, Expr **indices, unsigned numIndices);
+    IndexedArrayExpr(AstResource &resource,
+                     Expr *arrExpr, Expr **indices, unsigned numIndices);
 
     ///@{
     /// Returns the expression denoting the array to index.
@@ -453,17 +485,19 @@ class StringLiteral : public Expr
 
 public:
     /// Constructs a string literal over the given raw character data.  The data
-    /// is copied by the constructor (it is safe for the data to live in a
-    /// shared memory region).
-    StringLiteral(const char *string, unsigned len, Location loc)
+    /// is copied into storage allocated from the given resource (it is safe
+    /// for the data to live in a shared memory region).
+    StringLiteral(AstResource &resource,
+                  const char *string, unsigned len, Location loc)
         : Expr(AST_StringLiteral, loc) {
-        init(string, len);
+        init(resource, string, len);
     }
 
     /// Constructs a string literal using a pair of iterators.
-    StringLiteral(const char *start, const char *end, Location loc)
+    StringLiteral(AstResource &resource,
+                  const char *start, const char *end, Location loc)
         : Expr(AST_StringLiteral, loc) {
-        init(start, end - start);
+        init(resource, start, end - start);
     }
 
     /// Returns the type of this string literal once resolved.
@@ -566,7 +600,7 @@ private:
     InterpSet interps;
 
     /// Initialize this literal with the given character data.
-    void init(const char *string, unsigned len);
+    void init(AstResource &resource, const char *string, unsigned len);
 
     /// Returns an iterator to the given component declaration with the given
     /// type.
@@ -622,8 +656,6 @@ public:
         : Expr(AST_QualifiedExpr, qualifier->getType(), loc),
           prefix(qualifier), operand(operand) { }
 
-    ~QualifiedExpr() { delete operand; }
-
     //@{
     /// Returns the type declaration which qualifies this expression.
     const TypeDecl *getPrefix() const { return prefix; }
@@ -658,8 +690,6 @@ class DereferenceExpr : public Expr {
 public:
     DereferenceExpr(Expr *prefix, Location loc, bool isImplicit = false);
 
-    ~DereferenceExpr() { delete prefix; }
-
     //@{
     /// Returns the expression to which this dereference applies.
     const Expr *getPrefix() const { return prefix; }
@@ -700,7 +730,8 @@ public:
     ConversionExpr(Expr *operand, Type *target, Location loc, bool isImplicit)
         : Expr(AST_ConversionExpr, target, loc),
           operand(operand) {
-        bits = isImplicit;
+        if (isImplicit)
+            bits = Implicit_FLAG;
     }
 
     /// Returns the expression to be converted.
@@ -708,7 +739,15 @@ public:
     Expr *getOperand() { return operand; }
 
     // Returns true if this is an implicit conversion node.
-    bool isImplicit() const { return bits != 0; }
+    bool isImplicit() const { return bits & Implicit_FLAG; }
+
+    /// Marks this conversion as one whose operand is known to satisfy the
+    /// constraints of the target type, making any runtime check redundant.
+    void markAsStaticallyInRange() { bits |= InRange_FLAG; }
+
+    /// Returns true if the operand of this conversion is known to satisfy the
+    /// constraints of the target type.
+    bool isStaticallyInRange() const { return bits & InRange_FLAG; }
 
     // Support isa and dyn_cast.
     static bool classof(const ConversionExpr *node) { return true; }
@@ -717,6 +756,13 @@ public:
     }
 
 private:
+    /// The following enumeration defines the flags stored in the bits field
+    /// of this node.
+    enum PropertyFlag {
+        Implicit_FLAG = 1 << 0, // Set when this is an implicit conversion.
+        InRange_FLAG  = 1 << 1  // Set when the operand is known to be in range.
+    };
+
     Expr *operand;              ///< The expression to convert.
 };
 
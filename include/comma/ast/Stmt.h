@@ -163,7 +163,8 @@ public:
     ///
     /// If \p numChoices is zero, then the resulting handler is considered a
     /// "catch-all", corresponding to the code <tt>when others</tt>.
-    HandlerStmt(Location loc, ExceptionRef **choices, unsigned numChoices);
+    HandlerStmt(AstResource &resource, Location loc,
+                ExceptionRef **choices, unsigned numChoices);
 
     /// Returns the number of exception choices associated with this handlers.
     unsigned getNumChoices() const { return numChoices; }
@@ -236,7 +237,7 @@ private:
 class ProcedureCallStmt : public Stmt, public SubroutineCall {
 
 public:
-    ProcedureCallStmt(SubroutineRef *ref,
+    ProcedureCallStmt(AstResource &resource, SubroutineRef *ref,
                       Expr **positionalArgs, unsigned numPositional,
                       KeywordSelector **keyedArgs, unsigned numKeys);
 
@@ -271,8 +272,6 @@ public:
     ReturnStmt(Location loc, Expr *expr = 0)
         : Stmt(AST_ReturnStmt, loc), returnExpr(expr) { }
 
-    ~ReturnStmt();
-
     bool hasReturnExpr() const { return returnExpr != 0; }
 
     const Expr *getReturnExpr() const { return returnExpr; }
@@ -37,18 +37,17 @@ public:
     /// SubroutineCell is said to be ambiguous.
     ///
     /// SubroutineCall's take ownership of the connective and all arguments.
-    SubroutineCall(SubroutineRef *connective,
+    /// The argument vectors are allocated from the given resource.
+    SubroutineCall(AstResource &resource, SubroutineRef *connective,
                    Expr **positionalArgs, unsigned numPositional,
                    KeywordSelector **keyedArgs, unsigned numKeys);
 
     /// Constructs a subroutine call over a single connective.  This constructor
     /// always results in a fully resolved call node.
-    SubroutineCall(SubroutineDecl *connective,
+    SubroutineCall(AstResource &resource, SubroutineDecl *connective,
                    Expr **positionalArgs, unsigned numPositional,
                    KeywordSelector **keyedArgs, unsigned numKeys);
 
-    virtual ~SubroutineCall();
-
     /// Returns true if this is a function call expression.
     bool isaFunctionCall() const;
 
@@ -321,7 +320,8 @@ protected:
 
 private:
     /// Helper for the constructors.  Initializes the argument data.
-    void initializeArguments(Expr **posArgs, unsigned numPos,
+    void initializeArguments(AstResource &resource,
+                             Expr **posArgs, unsigned numPos,
                              KeywordSelector **keyArgs, unsigned numKeys);
 
     /// Extends the argument data with any keyed arguments.
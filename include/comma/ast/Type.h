@@ -144,8 +144,6 @@ private:
 class SubroutineType : public Type {
 
 public:
-    virtual ~SubroutineType() { delete[] argumentTypes; }
-
     /// Returns the number of arguments accepted by this type.
     unsigned getArity() const { return numArguments; }
 
@@ -181,7 +179,8 @@ public:
     }
 
 protected:
-    SubroutineType(AstKind kind, Type **argTypes, unsigned numArgs);
+    SubroutineType(AstKind kind, AstResource &resource,
+                   Type **argTypes, unsigned numArgs);
 
     Type **argumentTypes;
     unsigned numArguments;
@@ -212,8 +211,9 @@ private:
     /// Function types are constructed thru an AstResource.
     friend class AstResource;
 
-    FunctionType(Type **argTypes, unsigned numArgs, Type *returnType)
-        : SubroutineType(AST_FunctionType, argTypes, numArgs),
+    FunctionType(AstResource &resource,
+                 Type **argTypes, unsigned numArgs, Type *returnType)
+        : SubroutineType(AST_FunctionType, resource, argTypes, numArgs),
           returnType(returnType) { }
 
     /// Profiler used by AstResource to unique function type nodes.
@@ -246,8 +246,8 @@ private:
     /// ProcedureTypes are constructed thru AstResource.
     friend class AstResource;
 
-    ProcedureType(Type **argTypes, unsigned numArgs)
-        : SubroutineType(AST_ProcedureType, argTypes, numArgs) { }
+    ProcedureType(AstResource &resource, Type **argTypes, unsigned numArgs)
+        : SubroutineType(AST_ProcedureType, resource, argTypes, numArgs) { }
 
     /// Profiler used by AstResource to unique procedure type nodes.
     static void Profile(llvm::FoldingSetNodeID &ID,
@@ -271,41 +271,21 @@ public:
 
     /// \name Static Constructors.
     //@{
-    static UniversalType *getUniversalInteger() {
-        if (universal_integer)
-            return universal_integer;
-        universal_integer = new UniversalType();
-        return universal_integer;
-    }
+    static UniversalType *getUniversalInteger() { return &universal_integer; }
 
-    static UniversalType *getUniversalAccess() {
-        if (universal_access)
-            return universal_access;
-        universal_access = new UniversalType();
-        return universal_access;
-    }
+    static UniversalType *getUniversalAccess() { return &universal_access; }
 
-    static UniversalType *getUniversalFixed() {
-        if (universal_fixed)
-            return universal_fixed;
-        universal_fixed = new UniversalType();
-        return universal_fixed;
-    }
+    static UniversalType *getUniversalFixed() { return &universal_fixed; }
 
-    static UniversalType *getUniversalReal() {
-        if (universal_real)
-            return universal_real;
-        universal_real = new UniversalType();
-        return universal_real;
-    }
+    static UniversalType *getUniversalReal() { return &universal_real; }
     //@}
 
     /// \name Predicates.
     //@{
-    bool isUniversalIntegerType() const { return this == universal_integer; }
-    bool isUniversalAccessType()  const { return this == universal_access;  }
-    bool isUniversalFixedType()   const { return this == universal_fixed;   }
-    bool isUniversalRealType()    const { return this == universal_real;    }
+    bool isUniversalIntegerType() const { return this == &universal_integer; }
+    bool isUniversalAccessType()  const { return this == &universal_access;  }
+    bool isUniversalFixedType()   const { return this == &universal_fixed;   }
+    bool isUniversalRealType()    const { return this == &universal_real;    }
     //@}
 
     /// Returns the classification this universal type represents.
@@ -326,12 +306,12 @@ public:
 private:
     UniversalType() : Type(AST_UniversalType) { }
 
-    /// The various universal types.  Initialized on the first call to the get
-    /// routines.
-    static UniversalType *universal_integer;
-    static UniversalType *universal_access;
-    static UniversalType *universal_fixed;
-    static UniversalType *universal_real;
+    /// The various universal types.  These nodes are shared between all
+    /// AstResource instances and so are not allocated from any arena.
+    static UniversalType universal_integer;
+    static UniversalType universal_access;
+    static UniversalType universal_fixed;
+    static UniversalType universal_real;
 };
 
 //===----------------------------------------------------------------------===//
@@ -751,11 +731,13 @@ private:
                                    EnumerationDecl *decl);
 
     /// Builds an unconstrained enumeration subtype.
-    static EnumerationType *createSubtype(EnumerationType *rootType,
+    static EnumerationType *createSubtype(AstResource &resource,
+                                          EnumerationType *rootType,
                                           EnumerationDecl *decl = 0);
 
     /// Builds a constrained enumeration subtype over the given bounds.
-    static EnumerationType *createConstrainedSubtype(EnumerationType *rootType,
+    static EnumerationType *createConstrainedSubtype(AstResource &resource,
+                                                     EnumerationType *rootType,
                                                      Expr *lower, Expr *upper,
                                                      EnumerationDecl *decl);
     //@}
@@ -899,14 +881,16 @@ private:
                                const llvm::APInt &upper);
 
     /// Builds an unconstrained integer subtype.
-    static IntegerType *createSubtype(IntegerType *rootType,
+    static IntegerType *createSubtype(AstResource &resource,
+                                      IntegerType *rootType,
                                       IntegerDecl *decl = 0);
 
     /// Builds a constrained integer subtype over the given bounds.
     ///
     /// If \p decl is null an anonymous integer subtype is created.  Otherwise
     /// the constructed type is associated with the given declaration.
-    static IntegerType *createConstrainedSubtype(IntegerType *rootType,
+    static IntegerType *createConstrainedSubtype(AstResource &resource,
+                                                 IntegerType *rootType,
                                                  Expr *lower, Expr *upper,
                                                  IntegerDecl *decl);
 
@@ -986,8 +970,10 @@ public:
 private:
     friend class AstResource;
 
-    static PrivateType *createPrivateType(PrivateTypeDecl *decl);
-    static PrivateType *createPrivateSubtype(PrivateType *base);
+    static PrivateType *createPrivateType(AstResource &resource,
+                                          PrivateTypeDecl *decl);
+    static PrivateType *createPrivateSubtype(AstResource &resource,
+                                             PrivateType *base);
 
     // Internal constructor (not for use by AstResource).
     PrivateType(PrivateTypeDecl *decl);
@@ -138,6 +138,9 @@ public:
     /// Returns the number of note diagnostics posted.
     unsigned numNotes() const { return noteCount; }
 
+    /// Resets the diagnostic counts to zero.
+    void reset() { errorCount = warningCount = noteCount = 0; }
+
     /// Returns the stream this Diagnostic object posts to.
     llvm::raw_ostream &getStream() { return diagstream.getStream(); }
 
@@ -12,6 +12,10 @@
 #include "comma/basic/IdentifierInfo.h"
 #include "llvm/ADT/StringMap.h"
 
+namespace llvm {
+class raw_ostream;
+} // end llvm namespace.
+
 namespace comma {
 
 /// \class IdentifierPool
@@ -56,6 +60,27 @@ public:
         return pool.GetOrCreateValue(name, name + strlen(name)).getValue();
     }
 
+    /// \brief Returns the IdentifierInfo associated with the given StringRef.
+    ///
+    /// The string is hashed in place and copied only when a new IdentifierInfo
+    /// node is created.
+    ///
+    /// \param  name  The string to associate with an IdentifierInfo object.
+    ///
+    /// \return An interned (unique) IdentifierInfo object associated with \a
+    /// name.
+    IdentifierInfo &getIdentifierInfo(llvm::StringRef name) {
+        return getIdentifierInfo(name.data(), name.size());
+    }
+
+    /// \brief Returns the IdentifierInfo associated with the canonical (lower
+    /// case) form of the given name.
+    ///
+    /// This method is intended for names originating outside of the lexer,
+    /// such as those given on the command line.  Names scanned by the lexer
+    /// are canonicalized as they are read.
+    IdentifierInfo &getFoldedIdentifierInfo(llvm::StringRef name);
+
     /// \brief Returns the IdentifierInfo associated with the given std::string.
     ///
     /// \param  name  The string to associate with an IdentifierInfo object.
@@ -82,6 +107,10 @@ public:
 
     /// Returns the number of IdentifierInfo's managed by this pool.
     unsigned size() const { return pool.size(); }
+
+    /// Prints the number of entries in this pool and the memory they occupy
+    /// to the given stream.
+    void printStats(llvm::raw_ostream &stream) const;
 };
 
 } // End comma namespace
@@ -22,13 +22,15 @@ class TextProvider;
 /// instance of a TextProvider.  They function simply as a key which a
 /// TextProvider can interpret to provide line and column information.  More
 /// precisely, Locations are associated with a raw unsigned value known as its
-/// offset (since a TextProvider uses it as an index into internal tables to
-/// determine its associated line/column info).  An offset of zero is reserved
-/// to indicate an invalid or non-existent location.  In addition, a small
-/// numeric stamp labels an identifier as belonging to a particular
-/// TextProvider.  This allows locations to be properly associated with their
-/// corresponding TextProvider while keeping the Location objects themselves
-/// very small.
+/// offset.  An offset of zero is reserved to indicate an invalid or
+/// non-existent location.
+///
+/// Offsets are drawn from a single address space shared by all TextProviders
+/// managed by a TextManager.  Each provider occupies a contiguous range of
+/// offsets, one for each character of its text plus one denoting the end of the
+/// text.  The provider of origin is therefore determined by the offset alone,
+/// keeping Location objects very small without limiting the size or number of
+/// source files (short of a combined size of 4 GiB).
 ///
 /// Location objects are typically created via a call to
 /// TextProvider::getLocation.
@@ -38,18 +40,11 @@ class TextProvider;
 class Location {
 
 public:
-    /// Provides the maximum values that can be associated with a Location's
-    /// stamp and offset.
-    enum {
-        MAX_LOCATION_STAMP  = 4095,
-        MAX_LOCATION_OFFSET = 1048575
-    };
-
     /// \brief Constructs an invalid Location object.
-    Location() : stamp(0), offset(0) { }
+    Location() : offset(0) { }
 
-    /// \brief Constructs a Location with the given stamp and offset.
-    Location(unsigned stamp, unsigned offset) : stamp(stamp), offset(offset) { }
+    /// \brief Constructs a Location with the given offset.
+    explicit Location(unsigned offset) : offset(offset) { }
 
     /// \brief Returns true if this Location is invalid.
     ///
@@ -63,15 +58,11 @@ public:
     /// \brief Returns the offset associated with this Location.
     unsigned getOffset() const { return offset; }
 
-    /// \brief Returns the stamp associated with this Location.
-    unsigned getStamp() const { return stamp; }
-
     /// \brief Converts this Location to an unsigned integer.
     operator unsigned() const { return offset; }
 
 private:
-    unsigned stamp  : 12;
-    unsigned offset : 20;
+    unsigned offset;
 };
 
 /// \class SourceLocation
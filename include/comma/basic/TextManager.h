@@ -10,16 +10,26 @@
 #define COMMA_BASIC_TEXTMANAGER_HDR_GUARD
 
 #include "comma/basic/TextProvider.h"
-#include "llvm/ADT/DenseMap.h"
+
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+} // end llvm namespace.
 
 namespace comma {
 
 /// \class TextManager
 /// \brief Organizes a collection of TextProvider instances.
+///
+/// Each TextProvider created by a TextManager is assigned a distinct range of
+/// Location offsets, allocated in order of creation.  The provider of origin
+/// for any Location is found by a binary search over these ranges.
 class TextManager {
 
 public:
-    TextManager() : nextProviderID(0) { }
+    TextManager() : nextBase(1) { }
 
     /// Destroys a TextManager and all associated TextProvider instances.
     ~TextManager();
@@ -34,18 +44,32 @@ public:
     /// \param path The file used to back the TextProvider.
     TextProvider &create(const llvm::sys::Path& path);
 
+    /// \brief Destroys every TextProvider created over the given file.
+    ///
+    /// No Location produced by the released providers may be used afterwards.
+    /// The offsets of the released providers are reused when they are the
+    /// most recently created.
+    void release(const llvm::sys::Path &path);
 
     /// \brief Returns a SourceLocation object corresponding to the given
     /// Location object.
     SourceLocation getSourceLocation(const Location loc) const;
 
+    /// \brief Prints the number of managed TextProvider instances and the
+    /// memory they occupy to the given stream.
+    void printStats(llvm::raw_ostream &stream) const;
+
 private:
-    /// The next available TextProvider identifier.
-    unsigned nextProviderID;
+    /// The first unallocated Location offset.  Offset zero is reserved for
+    /// invalid locations.
+    unsigned nextBase;
+
+    /// The managed TextProvider objects, ordered by base offset.
+    typedef std::vector<TextProvider*> ProviderVector;
+    ProviderVector providers;
 
-    /// Map from provider ID's to managed TextProvider objects.
-    typedef llvm::DenseMap<unsigned, TextProvider*> ProviderMap;
-    ProviderMap providers;
+    /// The file backing each of the managed TextProvider objects.
+    std::vector<std::string> paths;
 };
 
 } // end comma namespace.
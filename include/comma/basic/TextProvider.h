@@ -10,8 +10,10 @@
 #define COMMA_BASIC_TEXTPROVIDER_HDR_GUARD
 
 #include "comma/basic/Location.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/System/Path.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <cassert>
 #include <string>
 #include <vector>
 
@@ -68,6 +70,11 @@ public:
         return copy;
     }
 
+    TextIterator &operator+=(unsigned n) {
+        cursor += n;
+        return *this;
+    }
+
     unsigned operator*() const {
         return *cursor;
     }
@@ -109,15 +116,14 @@ public:
     /// specifies a file name "-", then read from all of stdin instead.  If the
     /// path is invalid, this constructor will simply call abort.
     ///
-    /// The \p ID parameter is used to stamp all Location objects produced by
-    /// this TextProvider so that a raw Location object can be queried and
-    /// associated with the TextProvider of origin.
+    /// The \p base parameter gives the offset of the first character of the
+    /// text.  The Location objects produced by this TextProvider occupy the
+    /// range of offsets [base, base + getExtent()).
     ///
-    /// \param ID Stamp with which to mark all Location objects produced by this
-    /// TextProvider.
+    /// \param base The offset of the first character of the text.
     ///
     /// \param path The file used to back this TextProvider.
-    TextProvider(unsigned ID, const llvm::sys::Path& path);
+    TextProvider(unsigned base, const llvm::sys::Path& path);
 
     /// \brief Construct a TextProvider over the given buffer.
     ///
@@ -125,30 +131,20 @@ public:
     /// memory.  The contents of the buffer are copied -- the TextProvider does
     /// not take ownership of the memory region.
     ///
-    /// The \p ID parameter is used to stamp all Location objects produced by
-    /// this TextProvider so that a raw Location object can be queried and
-    /// associated with the TextProvider of origin.
-    ///
-    /// \param ID Stamp with which to mark all Location objects produced by this
-    /// TextProvider.
+    /// \param base The offset of the first character of the text.
     ///
     /// \param buffer Pointer to the start of the memory region.
     ///
     /// \param size The size in bytes of the memory region.
-    TextProvider(unsigned ID, const char *buffer, size_t size);
+    TextProvider(unsigned base, const char *buffer, size_t size);
 
     /// \brief Construct a TextProvider over the given string.  The contents of
     /// the string are copied.
     ///
-    /// The \p ID parameter is used to stamp all Location objects produced by
-    /// this TextProvider so that a raw Location object can be queried and
-    /// associated with the TextProvider of origin.
-    ///
-    /// \param ID Stamp with which to mark all Location objects produced by this
-    /// TextProvider.
+    /// \param base The offset of the first character of the text.
     ///
     /// \param string The string used to back this TextProvider.
-    TextProvider(unsigned ID, const std::string &string);
+    TextProvider(unsigned base, const std::string &string);
 
     ~TextProvider();
 
@@ -165,6 +161,15 @@ public:
     /// \brief Returns true if this TextProvider has been closed.
     bool isClosed() const { return memBuffer == 0; }
 
+    /// \brief Returns the size in bytes of the buffer backing this
+    /// TextProvider, or zero if the provider has been closed.
+    size_t getBufferSize() const;
+
+    /// \brief Returns the number of bytes occupied by the line table.
+    size_t getLineTableSize() const {
+        return lines.capacity() * sizeof(unsigned);
+    }
+
     /// \brief Returns a string identifying this TextProvider.
     ///
     /// The string is typically the name of the underlying file, or "<stdin>" if
@@ -173,12 +178,22 @@ public:
     /// memory buffers.
     std::string getIdentity() const { return identity; }
 
-    /// \brief Returns the numeric identifier unique to this TextProvider.
+    /// \brief Returns the offset of the first character of this TextProvider.
+    unsigned getBaseOffset() const { return base; }
+
+    /// \brief Returns the number of Location offsets occupied by this
+    /// TextProvider.
     ///
-    /// This method returns the ID value supplied to this TextProvider when
-    /// constructed, and with which all Location objects produced by this
-    /// TextProvider are stamped.
-    unsigned getNumericIdentity() const { return locationStamp; }
+    /// The extent covers every character of the text together with the
+    /// location one past the last character.  It remains valid after the
+    /// provider is closed.
+    unsigned getExtent() const { return extent; }
+
+    /// \brief Returns true if the given Location was produced by this
+    /// TextProvider.
+    bool contains(Location loc) const {
+        return base <= loc.getOffset() && loc.getOffset() - base < extent;
+    }
 
     /// \brief Returns the Location object corresponding to the position of the
     /// supplied TextIterator.
@@ -222,6 +237,32 @@ public:
     /// \brief Returns a sentinel iterator.
     TextIterator end() const;
 
+    /// \brief Provides a reference to a range of text.
+    ///
+    /// Returns a reference to the range of text starting at location \a start
+    /// and ending at location \a end, including both of its end points.  The
+    /// result refers directly into the buffer of this TextProvider and remains
+    /// valid until the provider is closed.
+    ///
+    /// \param start The location of the first character of the range.
+    ///
+    /// \param end The location of the last character of the range.
+    llvm::StringRef getText(Location start, Location end) const;
+
+    /// \brief Provides a reference to a range of text.
+    ///
+    /// Returns a reference to the range of text starting at the position of \a
+    /// iter and ending just before the position of \a endIter.  The result
+    /// refers directly into the buffer of this TextProvider and remains valid
+    /// until the provider is closed.
+    ///
+    /// \param iter The position of the first character of the range.
+    ///
+    /// \param endIter The position of one past the last character of the
+    /// range.
+    llvm::StringRef getText(const TextIterator &iter,
+                            const TextIterator &endIter) const;
+
     /// \brief Provides access to a range of text.
     ///
     /// Returns a string corresponding to the range of text starting at location
@@ -289,6 +330,14 @@ private:
         return ptr - buffer;
     }
 
+    /// Returns the offset into the underlying character buffer given a
+    /// Location produced by this TextProvider.
+    unsigned indexOf(Location loc) const {
+        assert(contains(loc) &&
+               "Location not associated with this TextProvider!");
+        return loc.getOffset() - base;
+    }
+
     /// Returns the indexes of the start and end of the line of text which
     /// contains the given location.
     std::pair<unsigned, unsigned> getLineOf(Location loc) const;
@@ -297,9 +346,10 @@ private:
     /// or the name of an input stream.
     std::string identity;
 
-    /// The numeric stamp used to mark all Location objects produced by this
-    /// TextProvider.
-    unsigned locationStamp;
+    /// The offset of the first character of this TextProvider, and the number
+    /// of offsets reserved for its text.
+    unsigned base;
+    unsigned extent;
 
     /// The underlying MemoryBuffer.
     llvm::MemoryBuffer *memBuffer;
@@ -0,0 +1,82 @@
+//===-- basic/TimeTrace.h ------------------------------------- -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// \brief Hierarchical compile time tracing.
+///
+/// Events are recorded as nested intervals and written in the Chrome trace
+/// event format, suitable for viewing with chrome://tracing or compatible
+/// tools.  Tracing is disabled by default, in which case recording an event
+/// costs a single test.
+//===----------------------------------------------------------------------===//
+
+#ifndef COMMA_BASIC_TIMETRACE_HDR_GUARD
+#define COMMA_BASIC_TIMETRACE_HDR_GUARD
+
+#include "llvm/ADT/StringRef.h"
+
+#include <string>
+
+namespace comma {
+
+/// \class TimeTrace
+/// \brief Global recorder of timed events.
+class TimeTrace {
+
+public:
+    /// Enables tracing, discarding any previously recorded events.  Event
+    /// times are measured relative to the moment of this call.
+    static void enable();
+
+    /// Returns true if tracing is enabled.
+    static bool isEnabled() { return enabled; }
+
+    /// Opens a new event with the given name.  The optional detail string
+    /// identifies the entity processed (a source file, subroutine, etc).
+    /// Events nest and must be closed in reverse order of opening.
+    static void begin(const char *name, llvm::StringRef detail = "");
+
+    /// Closes the most recently opened event.
+    static void end();
+
+    /// Writes all recorded events to the file at the given path.  Returns
+    /// false and emits a message to stderr if the file could not be written.
+    static bool write(const std::string &path);
+
+private:
+    static bool enabled;
+};
+
+/// \class TimeTraceScope
+/// \brief Records an event spanning the lifetime of the scope object.
+class TimeTraceScope {
+
+public:
+    TimeTraceScope(const char *name, llvm::StringRef detail = "")
+        : active(TimeTrace::isEnabled()) {
+        if (active)
+            TimeTrace::begin(name, detail);
+    }
+
+    ~TimeTraceScope() {
+        if (active)
+            TimeTrace::end();
+    }
+
+private:
+    bool active;
+
+    TimeTraceScope(const TimeTraceScope &);            // Do not implement.
+    TimeTraceScope &operator=(const TimeTraceScope &); // Likewise.
+};
+
+} // end comma namespace.
+
+#endif
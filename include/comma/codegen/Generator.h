@@ -43,6 +43,25 @@ public:
     ///
     virtual void emitEntry(ProcedureDecl *decl) = 0;
 
+    /// \brief Selects the optimizations applied to the generated code.
+    ///
+    /// When \p level is nonzero each subroutine is optimized immediately
+    /// after it is generated, and the module as a whole once a compilation
+    /// unit has been emitted.  Higher levels enable more aggressive
+    /// transformations (inlining, loop unrolling).  If \p optimizeSize is
+    /// true, smaller code is favored over faster code.  The default level is
+    /// zero, under which no optimizations are performed.
+    ///
+    /// This method must be called before any code is generated.
+    virtual void setOptimizationLevel(unsigned level, bool optimizeSize) = 0;
+
+    /// \brief Prints statistics describing the code generated so far to the
+    /// given stream.
+    ///
+    /// The report covers the entries of the type lowering table and the
+    /// number of LLVM instructions generated for each instance.
+    virtual void printStats(llvm::raw_ostream &stream) const = 0;
+
 protected:
     // Construct via subclasses.
     Generator() { }
@@ -13,6 +13,7 @@
 #include "comma/basic/TextProvider.h"
 
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Allocator.h"
 
 #include <iosfwd>
 
@@ -48,6 +49,18 @@ public:
     // representation, and have position information in the form of a single
     // Location entry (which must be interpreted with respect to a particular
     // TextProvider).
+    //
+    // Names (identifiers and attributes) additionally provide a key: the
+    // canonical form of the name folded to lower case.  The key is computed
+    // once by the lexer and is what should be interned, while the
+    // representation retains the spelling found in the source for use in
+    // diagnostics.
+    //
+    // String representations are not owned by the token.  They refer either
+    // directly into the TextProvider's buffer or, for keys which differ from
+    // the spelling of the name, into storage owned by the Lexer.  They
+    // therefore remain valid until the Lexer is destroyed or the TextProvider
+    // closed, whichever comes first.
     class Token {
 
     public:
@@ -57,7 +70,11 @@ public:
 
         Location getLocation() const { return location; }
 
-        llvm::StringRef getRep() const { return string.str(); }
+        llvm::StringRef getRep() const { return string; }
+
+        // Returns the canonical form of a name token.  For all other tokens
+        // this is identical to getRep().
+        llvm::StringRef getKey() const { return key; }
 
         unsigned getLength() const { return string.size(); }
 
@@ -67,15 +84,19 @@ public:
     private:
         Lexer::Code code;
         Location location;
-        llvm::SmallString<32> string;
+        llvm::StringRef string;
+        llvm::StringRef key;
 
         // Declare Lexer as a friend to give access to the following
-        // constructor.
+        // constructors.
         friend class Lexer;
 
         Token(Lexer::Code code, Location location, llvm::StringRef string)
-            : code(code), location(location),
-              string(string.begin(), string.end()) { }
+            : code(code), location(location), string(string), key(string) { }
+
+        Token(Lexer::Code code, Location location,
+              llvm::StringRef string, llvm::StringRef key)
+            : code(code), location(location), string(string), key(key) { }
     };
 
     // Scans a single token from the input stream.  When the stream is
@@ -187,9 +208,9 @@ private:
     void ignoreStream();
 
     // Returns the token code assoicated with the chatacters currently
-    // constained in nameBuff.  If the string exactly matches a reserved name
-    // (this function will not recignize glyph tokens) the corresponding code is
-    // returned, else UNUSED_ID if there is no match.
+    // constained in nameBuff.  If the string matches a reserved name ignoring
+    // case (this function will not recignize glyph tokens) the corresponding
+    // code is returned, else UNUSED_ID if there is no match.
     Code getTokenCode() const;
 
     void emitToken(Code code,
@@ -206,13 +227,22 @@ private:
     void emitRealToken(const TextIterator &start, const TextIterator &end);
 
     // Create an identifier token using the contents of nameBuff and the given
-    // location.
-    void emitIdentifierToken(Location loc);
+    // location.  \p start denotes the position of the first character of the
+    // name.
+    void emitIdentifierToken(Location loc, const TextIterator &start);
 
     // Create an attribute token using the contents of nameBuff (which is
     // assumed to contain only the attribute identifier and not the initial
-    // quote).  \p loc denotes the location of the attributes quote.
-    void emitAttributeToken(Location loc);
+    // quote).  \p loc denotes the location of the attributes quote, and \p
+    // start the position of the first character of the name.
+    void emitAttributeToken(Location loc, const TextIterator &start);
+
+    // Emits a token of the given kind for the name just consumed, with \p
+    // start denoting the first character of the name in the stream.  The key
+    // of the token is given by the contents of nameBuff.  When the name
+    // appears in canonical form in the source the key refers to the source
+    // buffer, otherwise to a copy in nameStorage.
+    void emitNameToken(Code code, Location loc, const TextIterator &start);
 
     void emitCharacterToken(const TextIterator &start, const TextIterator &end);
 
@@ -246,6 +276,10 @@ private:
     // An iterator into our stream.
     TextIterator currentIter;
 
+    // Pointer to the end of the character data (the position of the
+    // terminating null), bounding the block scanning routines.
+    const char *bufferEnd;
+
     // Numer of errors detected.
     unsigned errorCount;
 
@@ -264,9 +298,14 @@ private:
     std::vector<unsigned> positionStack;
 
     // Buffer area into which names are accumulated and canonicalized (with
-    // respect to case).
+    // respect to case).  The canonical form serves as the key of name
+    // tokens.
     llvm::SmallString<64> nameBuff;
 
+    // Storage for the keys of names which differ from their spelling in the
+    // source.
+    llvm::BumpPtrAllocator nameStorage;
+
     // Index into our token vector.  This index is non-zero only when an
     // excursion has ended with a call to endExcursion.
     unsigned index;
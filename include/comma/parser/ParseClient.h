@@ -14,6 +14,9 @@
 
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/Support/Allocator.h"
+
+#include <new>
 
 namespace llvm {
 
@@ -43,6 +46,9 @@ class ParseClient;
 // Node about to be freed, giving the ParseClient the opportunity to manage to
 // allocation of its data.
 //
+// The state shared between copies of a Node is allocated from a pool owned by
+// the ParseClient rather than from the heap.
+//
 // In general, automatic reclamation of nodes occurs when an error is
 // encountered during parsing, or during the analysis performed by the
 // ParseClient itself.  When the ParseClient accepts a particular construct that
@@ -94,11 +100,9 @@ class Node {
     // Construction of nodes is prohibited except by the ParseClient producing
     // them.  Thus, all direct constructors are private and we define the
     // ParseClient as a friend.
-    Node(ParseClient *client, void *ptr, NodeState::Property prop)
-        : state(new NodeState(client, ptr, prop)) { }
+    Node(ParseClient *client, void *ptr, NodeState::Property prop);
 
-    Node(ParseClient *client, void *ptr = 0)
-        : state(new NodeState(client, ptr)) { }
+    Node(ParseClient *client, void *ptr = 0);
 
     static Node getInvalidNode(ParseClient *client) {
         return Node(client, 0, NodeState::Invalid);
@@ -154,7 +158,7 @@ public:
 private:
     void dispose();
 
-    // Heap-allocated state associated with this node (and all copies).
+    // Pool allocated state associated with this node (and all copies).
     NodeState *state;
 };
 
@@ -172,6 +176,8 @@ public:
 class ParseClient {
 
 public:
+    ParseClient() : freeNodeStates(0), numLiveNodeStates(0) { }
+
     virtual ~ParseClient() { }
 
     /// Enumeration itemizing the various tags that can be associated with a
@@ -202,6 +208,12 @@ public:
     /// might choose to cache it, for instance.
     virtual void deleteNode(Node &node) = 0;
 
+    /// Releases the storage backing the nodes produced by this client.  This
+    /// method is called by the parser once a compilation unit has been
+    /// consumed.  It has no effect if any nodes produced by this client remain
+    /// live.
+    void releaseNodeStorage();
+
     /// Called to inform the client that a with clause has been parsed.
     ///
     /// \param loc Location of the 'with' reserved word.
@@ -870,18 +882,66 @@ protected:
         node.release();
         return node;
     }
+
+private:
+    friend class Node;
+
+    /// Storage for NodeState objects.  States are carved from the slabs of a
+    /// bump allocator and recycled through a free list (linked through the
+    /// payload field) once their reference count drops to zero.
+    llvm::BumpPtrAllocator nodeStorage;
+    Node::NodeState *freeNodeStates;
+    unsigned numLiveNodeStates;
+
+    Node::NodeState *allocateNodeState(void *ptr,
+                                       Node::NodeState::Property prop);
+    void deallocateNodeState(Node::NodeState *state);
 };
 
 //===----------------------------------------------------------------------===//
 // Inline methods.
 
+inline Node::NodeState *
+ParseClient::allocateNodeState(void *ptr, Node::NodeState::Property prop)
+{
+    void *mem = freeNodeStates;
+    if (mem)
+        freeNodeStates = static_cast<Node::NodeState*>(freeNodeStates->payload);
+    else
+        mem = nodeStorage.Allocate<Node::NodeState>();
+    ++numLiveNodeStates;
+    return new (mem) Node::NodeState(this, ptr, prop);
+}
+
+inline void ParseClient::deallocateNodeState(Node::NodeState *state)
+{
+    state->payload = freeNodeStates;
+    freeNodeStates = state;
+    --numLiveNodeStates;
+}
+
+inline void ParseClient::releaseNodeStorage()
+{
+    if (numLiveNodeStates == 0) {
+        freeNodeStates = 0;
+        nodeStorage.Reset();
+    }
+}
+
+inline Node::Node(ParseClient *client, void *ptr, NodeState::Property prop)
+    : state(client->allocateNodeState(ptr, prop)) { }
+
+inline Node::Node(ParseClient *client, void *ptr)
+    : state(client->allocateNodeState(ptr, NodeState::None)) { }
+
 inline void Node::dispose()
 {
     assert(state->rc != 0);
     if (--state->rc == 0) {
+        ParseClient *client = state->client.getPointer();
         if (isOwning())
-            state->client.getPointer()->deleteNode(*this);
-        delete state;
+            client->deleteNode(*this);
+        client->deallocateNodeState(state);
     }
 }
 
@@ -0,0 +1,73 @@
+//===-- parser/SpecParser.h ----------------------------------- -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef COMMA_PARSER_SPECPARSER_HDR_GUARD
+#define COMMA_PARSER_SPECPARSER_HDR_GUARD
+
+#include "comma/parser/ParserBase.h"
+
+#include <vector>
+
+namespace comma {
+
+/// \class
+/// \brief Parses a Comma source file to determine the regions of text which
+/// define its public interface.
+///
+/// The interface of a source file consists of its context clauses and the
+/// complete specification (including the private part) of each package it
+/// declares.  Package bodies are skipped.  The source is assumed to have
+/// already been accepted by the full parser and type checker -- only the
+/// coarse structure of the file is inspected.
+class SpecParser : public ParserBase {
+
+public:
+    SpecParser(TextProvider   &txtProvider,
+               IdentifierPool &idPool,
+               Diagnostic     &diag)
+        : ParserBase(txtProvider, idPool, diag),
+          seenBodyPragma(false) { }
+
+    /// Each range delimits the first and last character of a context clause or
+    /// package specification.
+    typedef std::pair<Location, Location> SpecRange;
+    typedef std::vector<SpecRange> SpecRangeVector;
+
+    /// Populates the given vector with the ranges of text defining the
+    /// interface of the source.  Returns true if the parse was successful and
+    /// false otherwise.
+    bool parseSpecification(SpecRangeVector &ranges);
+
+    /// Returns true if a pragma was found within a package body.
+    ///
+    /// Pragmas within a body (pragma Import in particular) can complete the
+    /// declarations of the public view.  Such information is not captured by
+    /// the specification ranges alone.
+    bool hasBodyPragmas() const { return seenBodyPragma; }
+
+private:
+    bool seenBodyPragma;
+
+    /// Parses a with clause and appends its range to the given vector.
+    bool parseWithClause(SpecRangeVector &ranges);
+
+    /// Parses a package specification and appends its range to the given
+    /// vector.  Package bodies are consumed but do not contribute a range.
+    bool parsePackage(SpecRangeVector &ranges);
+
+    /// Consumes all tokens up to and including the end tag of the package body
+    /// with the given name.
+    bool skipPackageBody(IdentifierInfo *name);
+
+    /// Returns true if the current token can begin a top level form.
+    bool atTopLevelForm();
+};
+
+} // end comma namespace.
+
+#endif
@@ -7,6 +7,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "comma/ast/AggExpr.h"
+#include "comma/ast/AstResource.h"
+
+#include <algorithm>
 
 using namespace comma;
 using llvm::dyn_cast;
@@ -67,26 +70,77 @@ void ComponentKey::getUpperValue(llvm::APInt &value) const
         getAsExpr()->staticDiscreteValue(value);
 }
 
-bool ComponentKey::compareKeysU(const ComponentKey *X, const ComponentKey *Y)
+//===----------------------------------------------------------------------===//
+// KeyIntervalSet
+
+void KeyIntervalSet::addKey(ComponentKey *key)
 {
-    assert(X->isComparable() && Y->isComparable() && "Keys not comparable!");
+    assert(key->isComparable() && "Key not comparable!");
 
-    llvm::APInt boundX;
-    llvm::APInt boundY;
-    X->getLowerValue(boundX);
-    Y->getLowerValue(boundY);
-    return boundX.getZExtValue() < boundY.getZExtValue();
+    llvm::APInt lower;
+    llvm::APInt upper;
+    key->getLowerValue(lower);
+    key->getUpperValue(upper);
+
+    Interval entry;
+    if (isSigned) {
+        entry.lower = encode(lower.getSExtValue());
+        entry.upper = encode(upper.getSExtValue());
+    }
+    else {
+        entry.lower = lower.getZExtValue();
+        entry.upper = upper.getZExtValue();
+    }
+    entry.first = key;
+    entry.last = key;
+    runs.push_back(entry);
+}
+
+void KeyIntervalSet::build()
+{
+    overlapX = 0;
+    overlapY = 0;
+
+    if (runs.empty())
+        return;
+
+    std::sort(runs.begin(), runs.end());
+
+    // Merge the sorted keys in place.  Each key either overlaps the current
+    // run, extends it, or starts a new one.
+    IntervalVec::iterator current = runs.begin();
+    IntervalVec::iterator I = current;
+    IntervalVec::iterator E = runs.end();
+    while (++I != E) {
+        if (I->lower <= current->upper) {
+            if (!overlapX) {
+                overlapX = current->last;
+                overlapY = I->first;
+            }
+            if (I->upper > current->upper) {
+                current->upper = I->upper;
+                current->last = I->last;
+            }
+        }
+        else if (I->lower == current->upper + 1) {
+            current->upper = I->upper;
+            current->last = I->last;
+        }
+        else
+            *++current = *I;
+    }
+    runs.erase(++current, E);
 }
 
-bool ComponentKey::compareKeysS(const ComponentKey *X, const ComponentKey *Y)
+bool KeyIntervalSet::getDiscontinuity(ComponentKey *&X,
+                                      ComponentKey *&Y) const
 {
-    assert(X->isComparable() && Y->isComparable() && "Keys not comparable!");
+    if (runs.size() < 2)
+        return false;
 
-    llvm::APInt boundX;
-    llvm::APInt boundY;
-    X->getLowerValue(boundX);
-    Y->getLowerValue(boundY);
-    return boundX.getSExtValue() < boundY.getSExtValue();
+    X = runs[0].last;
+    Y = runs[1].first;
+    return true;
 }
 
 //===----------------------------------------------------------------------===//
@@ -101,7 +155,8 @@ ComponentKeyList::ComponentKeyList(ComponentKey **keys, unsigned numKeys,
     std::copy(keys, keys + numKeys, this->keys);
 }
 
-ComponentKeyList *ComponentKeyList::create(ComponentKey **keys,
+ComponentKeyList *ComponentKeyList::create(AstResource &resource,
+                                           ComponentKey **keys,
                                            unsigned numKeys, Expr *expr)
 {
     assert(numKeys != 0 && "At leaast one key must be present!");
@@ -109,40 +164,16 @@ ComponentKeyList *ComponentKeyList::create(ComponentKey **keys,
     // Calculate the size of the needed ComponentKeyList and allocate the raw
     // memory.
     unsigned size = sizeof(ComponentKeyList) + sizeof(ComponentKey*) * numKeys;
-    char *raw = new char[size];
+    void *raw = resource.allocate(size);
 
     // Placement operator new using the classes constructor initializes the
     // internal structure.
     return new (raw) ComponentKeyList(keys, numKeys, expr);
 }
 
-void ComponentKeyList::dispose(ComponentKeyList *CKL)
-{
-    // Deallocate the associated AST nodes.
-    delete CKL->expr;
-    for (iterator I = CKL->begin(); I != CKL->end(); ++I)
-        delete *I;
-
-    // Cast CKL back to a raw pointer to char and deallocate.
-    char *raw = reinterpret_cast<char*>(CKL);
-    delete [] raw;
-}
-
 //===----------------------------------------------------------------------===//
 // AggregateExpr
 
-AggregateExpr::~AggregateExpr()
-{
-    for (pos_iterator I = pos_begin(); I != pos_end(); ++I)
-        delete *I;
-
-    for (kl_iterator I = kl_begin(); I != kl_end(); ++I)
-        ComponentKeyList::dispose(*I);
-
-    if (Expr *others = getOthersExpr())
-        delete others;
-}
-
 bool AggregateExpr::empty() const
 {
     return !(hasOthers() || hasKeyedComponents() || hasPositionalComponents());
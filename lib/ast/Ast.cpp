@@ -7,8 +7,21 @@
 //===----------------------------------------------------------------------===//
 
 #include "AstDumper.h"
+#include "comma/ast/AggExpr.h"
 #include "comma/ast/Ast.h"
+#include "comma/ast/AstResource.h"
+#include "comma/ast/AttribDecl.h"
+#include "comma/ast/DSTDefinition.h"
+#include "comma/ast/ExceptionRef.h"
+#include "comma/ast/KeywordSelector.h"
+#include "comma/ast/PackageRef.h"
+#include "comma/ast/Range.h"
+#include "comma/ast/RangeAttrib.h"
+#include "comma/ast/STIndication.h"
 #include "comma/ast/SubroutineRef.h"
+#include "comma/ast/TypeRef.h"
+
+#include "llvm/Support/Format.h"
 
 #include <algorithm>
 
@@ -102,11 +115,115 @@ const char *Ast::kindStrings[LAST_AstKind] = {
     "SubroutineRef",
     "TypeRef",
     "ExceptionRef",
+    "PackageRef",
     "Identifier",
     "ComponentKey",
     "PrivatePart"
 };
 
+unsigned Ast::createdCounts[LAST_AstKind];
+unsigned Ast::liveCounts[LAST_AstKind];
+
+const unsigned Ast::kindSizes[LAST_AstKind] = {
+    sizeof(PackageDecl),
+    sizeof(BodyDecl),
+
+    sizeof(AccessDecl),
+    sizeof(EnumerationDecl),
+    sizeof(IncompleteTypeDecl),
+    sizeof(IntegerDecl),
+    sizeof(ArrayDecl),
+    sizeof(PrivateTypeDecl),
+    sizeof(RecordDecl),
+
+    sizeof(PkgInstanceDecl),
+
+    sizeof(LoopDecl),
+    sizeof(ObjectDecl),
+    sizeof(ParamValueDecl),
+    sizeof(RenamedObjectDecl),
+
+    sizeof(ProcedureDecl),
+    sizeof(FunctionDecl),
+    sizeof(EnumLiteral),
+    sizeof(PosAD),
+    sizeof(ValAD),
+    sizeof(UseDecl),
+    sizeof(ExceptionDecl),
+    sizeof(ComponentDecl),
+
+    sizeof(UniversalType),
+    sizeof(FunctionType),
+    sizeof(ProcedureType),
+
+    sizeof(AccessType),
+    sizeof(ArrayType),
+    sizeof(EnumerationType),
+    sizeof(IncompleteType),
+    sizeof(IntegerType),
+    sizeof(PrivateType),
+    sizeof(RecordType),
+
+    sizeof(AllocatorExpr),
+    sizeof(ConversionExpr),
+    sizeof(DiamondExpr),
+    sizeof(DeclRefExpr),
+    sizeof(DereferenceExpr),
+    sizeof(FunctionCallExpr),
+    sizeof(IndexedArrayExpr),
+    sizeof(IntegerLiteral),
+    sizeof(NullExpr),
+    sizeof(AggregateExpr),
+    sizeof(QualifiedExpr),
+    sizeof(SelectedExpr),
+    sizeof(StringLiteral),
+
+    sizeof(FirstAE),
+    sizeof(FirstArrayAE),
+    sizeof(LastArrayAE),
+    sizeof(LengthAE),
+    sizeof(LastAE),
+
+    sizeof(AssignmentStmt),
+    sizeof(BlockStmt),
+    sizeof(ForStmt),
+    sizeof(HandlerStmt),
+    sizeof(IfStmt),
+    sizeof(LoopStmt),
+    sizeof(ExitStmt),
+    sizeof(NullStmt),
+    sizeof(ProcedureCallStmt),
+    sizeof(RaiseStmt),
+    sizeof(ReturnStmt),
+    sizeof(StmtSequence),
+    sizeof(WhileStmt),
+    sizeof(PragmaStmt),
+
+    sizeof(KeywordSelector),
+    sizeof(DSTDefinition),
+    sizeof(STIndication),
+    sizeof(Range),
+    sizeof(ArrayRangeAttrib),
+    sizeof(ScalarRangeAttrib),
+    sizeof(SubroutineRef),
+    sizeof(TypeRef),
+    sizeof(ExceptionRef),
+    sizeof(PackageRef),
+    sizeof(Identifier),
+    sizeof(ComponentKey),
+    sizeof(PrivatePart)
+};
+
+void *Ast::operator new(size_t bytes, AstResource &resource)
+{
+    return resource.allocateNode(bytes);
+}
+
+void Ast::operator delete(void *ptr)
+{
+    AstResource::releaseNode(ptr);
+}
+
 void Ast::dump()
 {
     AstDumper dumper(llvm::errs());
@@ -114,6 +231,31 @@ void Ast::dump()
     llvm::errs().flush();
 }
 
+void Ast::printStats(llvm::raw_ostream &stream)
+{
+    unsigned totalCreated = 0;
+    unsigned totalLive = 0;
+    uint64_t totalBytes = 0;
+
+    stream << "*** AST node statistics:\n";
+    stream << llvm::format("  %-20s %10s %10s %12s\n",
+                           "kind", "created", "live", "live bytes");
+    for (unsigned i = 0; i < LAST_AstKind; ++i) {
+        if (!createdCounts[i])
+            continue;
+        uint64_t bytes = uint64_t(liveCounts[i]) * kindSizes[i];
+        stream << llvm::format("  %-20s %10u %10u %12llu\n",
+                               kindStrings[i], createdCounts[i],
+                               liveCounts[i], (unsigned long long)bytes);
+        totalCreated += createdCounts[i];
+        totalLive += liveCounts[i];
+        totalBytes += bytes;
+    }
+    stream << llvm::format("  %-20s %10u %10u %12llu\n", "total",
+                           totalCreated, totalLive,
+                           (unsigned long long)totalBytes);
+}
+
 //===----------------------------------------------------------------------===//
 // Nodes which do not belong to any of the major branches in the AST hierarchy
 // (Type, Decl, Expr) have their out or line members define below.
@@ -12,6 +12,8 @@
 #include "comma/ast/Expr.h"
 #include "comma/ast/Type.h"
 
+#include "llvm/Support/raw_ostream.h"
+
 using namespace comma;
 using llvm::dyn_cast;
 using llvm::cast_or_null;
@@ -19,11 +21,56 @@ using llvm::cast;
 using llvm::isa;
 
 AstResource::AstResource(IdentifierPool &idPool)
-    : idPool(idPool)
+    : idPool(idPool),
+      parent(0),
+      nodeBytes(0)
 {
     initializeLanguageDefinedNodes();
 }
 
+AstResource::AstResource(AstResource &parent)
+    : idPool(parent.idPool),
+      parent(&parent),
+      nodeBytes(0),
+      theBooleanDecl(parent.theBooleanDecl),
+      theCharacterDecl(parent.theCharacterDecl),
+      theRootIntegerDecl(parent.theRootIntegerDecl),
+      theIntegerDecl(parent.theIntegerDecl),
+      theNaturalDecl(parent.theNaturalDecl),
+      thePositiveDecl(parent.thePositiveDecl),
+      theStringDecl(parent.theStringDecl),
+      theProgramError(parent.theProgramError),
+      theConstraintError(parent.theConstraintError),
+      theAssertionError(parent.theAssertionError) { }
+
+AstResource::~AstResource()
+{
+    // Run the destructor of every node which was not deleted explicitly.  No
+    // destructor refers to another node, so the order is immaterial.  The
+    // storage of the nodes is released along with the arena.
+    typedef std::vector<NodeHeader*>::iterator iterator;
+    for (iterator I = nodes.begin(); I != nodes.end(); ++I) {
+        NodeHeader *header = *I;
+        if (header->live)
+            reinterpret_cast<Ast*>(header + 1)->~Ast();
+    }
+}
+
+void *AstResource::allocateNode(size_t bytes)
+{
+    void *raw = allocate(sizeof(NodeHeader) + bytes);
+    NodeHeader *header = static_cast<NodeHeader*>(raw);
+    header->live = true;
+    nodes.push_back(header);
+    return header + 1;
+}
+
+void AstResource::releaseNode(void *ptr)
+{
+    NodeHeader *header = static_cast<NodeHeader*>(ptr) - 1;
+    header->live = false;
+}
+
 void AstResource::initializeLanguageDefinedNodes()
 {
     initializeBoolean();
@@ -110,8 +157,8 @@ void AstResource::initializeRootInteger()
     IdentifierInfo *id = getIdentifierInfo("root_integer");
     llvm::APInt lower = llvm::APInt::getSignedMinValue(64);
     llvm::APInt upper = llvm::APInt::getSignedMaxValue(64);
-    IntegerLiteral *lowerExpr = new IntegerLiteral(lower, Location());
-    IntegerLiteral *upperExpr = new IntegerLiteral(upper, Location());
+    IntegerLiteral *lowerExpr = new (*this) IntegerLiteral(lower, Location());
+    IntegerLiteral *upperExpr = new (*this) IntegerLiteral(upper, Location());
     theRootIntegerDecl =
         createIntegerDecl(id, Location(), lowerExpr, upperExpr, 0);
 }
@@ -122,8 +169,8 @@ void AstResource::initializeInteger()
     IdentifierInfo *integerId = getIdentifierInfo("integer");
     llvm::APInt lower = llvm::APInt::getSignedMinValue(32);
     llvm::APInt upper = llvm::APInt::getSignedMaxValue(32);
-    IntegerLiteral *lowerExpr = new IntegerLiteral(lower, Location());
-    IntegerLiteral *upperExpr = new IntegerLiteral(upper, Location());
+    IntegerLiteral *lowerExpr = new (*this) IntegerLiteral(lower, Location());
+    IntegerLiteral *upperExpr = new (*this) IntegerLiteral(upper, Location());
     theIntegerDecl = createIntegerDecl(integerId, Location(),
                                        lowerExpr, upperExpr, 0);
 }
@@ -140,8 +187,8 @@ void AstResource::initializeNatural()
     type->getUpperLimit(highInt);
 
     // Allocate static expressions for the bounds.
-    Expr *low = new IntegerLiteral(lowInt, type, Location());
-    Expr *high = new IntegerLiteral(highInt, type, Location());
+    Expr *low = new (*this) IntegerLiteral(lowInt, type, Location());
+    Expr *high = new (*this) IntegerLiteral(highInt, type, Location());
 
     theNaturalDecl =
         createIntegerSubtypeDecl(name, Location(), type, low, high, 0);
@@ -157,8 +204,8 @@ void AstResource::initializePositive()
     type->getUpperLimit(highInt);
 
     // Allocate static expressions for the bounds.
-    Expr *low = new IntegerLiteral(lowInt, type, Location());
-    Expr *high = new IntegerLiteral(highInt, type, Location());
+    Expr *low = new (*this) IntegerLiteral(lowInt, type, Location());
+    Expr *high = new (*this) IntegerLiteral(highInt, type, Location());
 
     thePositiveDecl =
         createIntegerSubtypeDecl(name, Location(), type, low, high, 0);
@@ -169,7 +216,7 @@ void AstResource::initializeString()
     IdentifierInfo *name = getIdentifierInfo("string");
     DiscreteType *indexTy = getThePositiveType();
     DSTDefinition::DSTTag tag = DSTDefinition::Type_DST;
-    DSTDefinition *DST = new DSTDefinition(Location(), indexTy, tag);
+    DSTDefinition *DST = new (*this) DSTDefinition(Location(), indexTy, tag);
     theStringDecl = createArrayDecl(name, Location(), 1, &DST,
                                     getTheCharacterType(), false, 0);
 }
@@ -178,15 +225,17 @@ void AstResource::initializeExceptions()
 {
     IdentifierInfo *PEName = getIdentifierInfo("program_error");
     ExceptionDecl::ExceptionKind PEKind = ExceptionDecl::Program_Error;
-    theProgramError = new ExceptionDecl(PEKind, PEName, Location(), 0);
+    theProgramError = new (*this) ExceptionDecl(PEKind, PEName, Location(), 0);
 
     IdentifierInfo *CEName = getIdentifierInfo("constraint_error");
     ExceptionDecl::ExceptionKind CEKind = ExceptionDecl::Constraint_Error;
-    theConstraintError = new ExceptionDecl(CEKind, CEName, Location(), 0);
+    theConstraintError =
+        new (*this) ExceptionDecl(CEKind, CEName, Location(), 0);
 
     IdentifierInfo *AEName = getIdentifierInfo("assertion_error");
     ExceptionDecl::ExceptionKind AEKind = ExceptionDecl::Assertion_Error;
-    theAssertionError = new ExceptionDecl(AEKind, AEName, Location(), 0);
+    theAssertionError =
+        new (*this) ExceptionDecl(AEKind, AEName, Location(), 0);
 }
 
 /// Accessors to the language defined types.  We keep these out of line since we
@@ -233,10 +282,17 @@ FunctionType *AstResource::getFunctionType(Type **argTypes, unsigned numArgs,
     FunctionType::Profile(ID, argTypes, numArgs, returnType);
 
     void *pos = 0;
+    AstResource *ancestor;
+    for (ancestor = parent; ancestor; ancestor = ancestor->parent) {
+        FunctionType *uniqued;
+        if ((uniqued = ancestor->functionTypes.FindNodeOrInsertPos(ID, pos)))
+            return uniqued;
+    }
     if (FunctionType *uniqued = functionTypes.FindNodeOrInsertPos(ID, pos))
         return uniqued;
 
-    FunctionType *res = new FunctionType(argTypes, numArgs, returnType);
+    FunctionType *res;
+    res = new (*this) FunctionType(*this, argTypes, numArgs, returnType);
     functionTypes.InsertNode(res, pos);
     return res;
 }
@@ -247,10 +303,16 @@ ProcedureType *AstResource::getProcedureType(Type **argTypes, unsigned numArgs)
     ProcedureType::Profile(ID, argTypes, numArgs);
 
     void *pos = 0;
+    AstResource *ancestor;
+    for (ancestor = parent; ancestor; ancestor = ancestor->parent) {
+        ProcedureType *uniqued;
+        if ((uniqued = ancestor->procedureTypes.FindNodeOrInsertPos(ID, pos)))
+            return uniqued;
+    }
     if (ProcedureType *uniqued = procedureTypes.FindNodeOrInsertPos(ID, pos))
         return uniqued;
 
-    ProcedureType *res = new ProcedureType(argTypes, numArgs);
+    ProcedureType *res = new (*this) ProcedureType(*this, argTypes, numArgs);
     procedureTypes.InsertNode(res, pos);
     return res;
 }
@@ -261,7 +323,8 @@ AstResource::createEnumDecl(IdentifierInfo *name, Location loc,
                             unsigned numElems, DeclRegion *parent)
 {
     EnumerationDecl *res;
-    res = new EnumerationDecl(*this, name, loc, elems, numElems, parent);
+    res = new (*this) EnumerationDecl(*this, name, loc, elems, numElems,
+                                      parent);
     decls.push_back(res);
     return res;
 }
@@ -273,7 +336,8 @@ AstResource::createEnumSubtypeDecl(IdentifierInfo *name, Location loc,
                                    DeclRegion *region)
 {
     EnumerationDecl *res;
-    res = new EnumerationDecl(*this, name, loc, subtype, lower, upper, region);
+    res = new (*this) EnumerationDecl(*this, name, loc, subtype, lower, upper,
+                                      region);
     decls.push_back(res);
     return res;
 }
@@ -284,7 +348,7 @@ AstResource::createEnumSubtypeDecl(IdentifierInfo *name, Location loc,
                                    DeclRegion *region)
 {
     EnumerationDecl *res;
-    res = new EnumerationDecl(*this, name, loc, subtype, region);
+    res = new (*this) EnumerationDecl(*this, name, loc, subtype, region);
     decls.push_back(res);
     return res;
 }
@@ -300,7 +364,7 @@ EnumerationType *AstResource::createEnumSubtype(EnumerationType *base,
                                                 EnumerationDecl *decl)
 {
     decl = decl ? decl : cast<EnumerationDecl>(base->getDefiningDecl());
-    EnumerationType *res = EnumerationType::createSubtype(base, decl);
+    EnumerationType *res = EnumerationType::createSubtype(*this, base, decl);
     types.push_back(res);
     return res;
 }
@@ -311,7 +375,8 @@ EnumerationType *AstResource::createEnumSubtype(EnumerationType *base,
 {
     EnumerationType *res;
     decl = decl ? decl : cast<EnumerationDecl>(base->getDefiningDecl());
-    res = EnumerationType::createConstrainedSubtype(base, low, high, decl);
+    res = EnumerationType::createConstrainedSubtype(*this, base,
+                                                    low, high, decl);
     types.push_back(res);
     return res;
 }
@@ -321,7 +386,8 @@ IntegerDecl *AstResource::createIntegerDecl(IdentifierInfo *name, Location loc,
                                             DeclRegion *parent)
 {
     IntegerDecl *res;
-    res = new IntegerDecl(*this, name, loc, lowRange, highRange, parent);
+    res = new (*this) IntegerDecl(*this, name, loc, lowRange, highRange,
+                                  parent);
     decls.push_back(res);
     return res;
 }
@@ -330,7 +396,7 @@ IntegerDecl *AstResource::createIntegerDecl(IdentifierInfo *name, Location loc,
                                             Expr *modulus, DeclRegion *parent)
 {
     IntegerDecl *res;
-    res = new IntegerDecl(*this, name, loc, modulus, parent);
+    res = new (*this) IntegerDecl(*this, name, loc, modulus, parent);
     decls.push_back(res);
     return res;
 }
@@ -341,7 +407,7 @@ AstResource::createIntegerSubtypeDecl(IdentifierInfo *name, Location loc,
                                       Expr *lower, Expr *upper,
                                       DeclRegion *parent)
 {
-    IntegerDecl *res = new IntegerDecl
+    IntegerDecl *res = new (*this) IntegerDecl
         (*this, name, loc, subtype, lower, upper, parent);
     decls.push_back(res);
     return res;
@@ -351,7 +417,7 @@ IntegerDecl *
 AstResource::createIntegerSubtypeDecl(IdentifierInfo *name, Location loc,
                                       IntegerType *subtype, DeclRegion *parent)
 {
-    IntegerDecl *res = new IntegerDecl
+    IntegerDecl *res = new (*this) IntegerDecl
         (*this, name, loc, subtype, parent);
     decls.push_back(res);
     return res;
@@ -372,7 +438,8 @@ IntegerType *AstResource::createIntegerSubtype(IntegerType *base,
 {
     IntegerType *res;
     decl = decl ? decl : cast<IntegerDecl>(base->getDefiningDecl());
-    res = IntegerType::createConstrainedSubtype(base, low, high, decl);
+    res = IntegerType::createConstrainedSubtype(*this, base,
+                                                low, high, decl);
     types.push_back(res);
     return res;
 }
@@ -382,8 +449,8 @@ IntegerType *AstResource::createIntegerSubtype(IntegerType *base,
                                                const llvm::APInt &high,
                                                IntegerDecl *decl)
 {
-    Expr *lowExpr = new IntegerLiteral(low, base, Location());
-    Expr *highExpr = new IntegerLiteral(high, base, Location());
+    Expr *lowExpr = new (*this) IntegerLiteral(low, base, Location());
+    Expr *highExpr = new (*this) IntegerLiteral(high, base, Location());
     decl = decl ? decl : cast<IntegerDecl>(base->getDefiningDecl());
     return createIntegerSubtype(base, lowExpr, highExpr, decl);
 }
@@ -392,7 +459,7 @@ IntegerType *AstResource::createIntegerSubtype(IntegerType *base,
                                                IntegerDecl *decl)
 {
     decl = decl ? decl : cast<IntegerDecl>(base->getDefiningDecl());
-    IntegerType *res = IntegerType::createSubtype(base, decl);
+    IntegerType *res = IntegerType::createSubtype(*this, base, decl);
     types.push_back(res);
     return res;
 }
@@ -418,8 +485,8 @@ PrivateType *AstResource::createPrivateType(PrivateTypeDecl *decl)
     PrivateType *base;
     PrivateType *subtype;
 
-    base = PrivateType::createPrivateType(decl);
-    subtype = PrivateType::createPrivateSubtype(base);
+    base = PrivateType::createPrivateType(*this, decl);
+    subtype = PrivateType::createPrivateSubtype(*this, base);
     types.push_back(base);
     types.push_back(subtype);
     return subtype;
@@ -430,8 +497,8 @@ ArrayDecl *AstResource::createArrayDecl(IdentifierInfo *name, Location loc,
                                         Type *component, bool isConstrained,
                                         DeclRegion *parent)
 {
-    ArrayDecl *res = new ArrayDecl(*this, name, loc, rank, indices, component,
-                                   isConstrained, parent);
+    ArrayDecl *res = new (*this) ArrayDecl(*this, name, loc, rank, indices,
+                                           component, isConstrained, parent);
     decls.push_back(res);
     return res;
 }
@@ -441,7 +508,7 @@ ArrayType *AstResource::createArrayType(ArrayDecl *decl,
                                         Type *component, bool isConstrained)
 {
     ArrayType *res;
-    res = new ArrayType(decl, rank, indices, component, isConstrained);
+    res = new (*this) ArrayType(decl, rank, indices, component, isConstrained);
     types.push_back(res);
     return res;
 }
@@ -450,7 +517,7 @@ ArrayType *AstResource::createArraySubtype(IdentifierInfo *name,
                                            ArrayType *base,
                                            DiscreteType **indices)
 {
-    ArrayType *res = new ArrayType(name, base, indices);
+    ArrayType *res = new (*this) ArrayType(name, base, indices);
     types.push_back(res);
     return res;
 }
@@ -458,7 +525,7 @@ ArrayType *AstResource::createArraySubtype(IdentifierInfo *name,
 ArrayType *AstResource::createArraySubtype(ArrayType *base,
                                            DiscreteType **indices)
 {
-    ArrayType *res = new ArrayType(base, indices);
+    ArrayType *res = new (*this) ArrayType(base, indices);
     types.push_back(res);
     return res;
 }
@@ -466,7 +533,7 @@ ArrayType *AstResource::createArraySubtype(ArrayType *base,
 ArrayType *AstResource::createArraySubtype(IdentifierInfo *name,
                                            ArrayType *base)
 {
-    ArrayType *res = new ArrayType(name, base);
+    ArrayType *res = new (*this) ArrayType(name, base);
     types.push_back(res);
     return res;
 }
@@ -474,14 +541,14 @@ ArrayType *AstResource::createArraySubtype(IdentifierInfo *name,
 RecordDecl *AstResource::createRecordDecl(IdentifierInfo *name, Location loc,
                                           DeclRegion *parent)
 {
-    RecordDecl *res = new RecordDecl(*this, name, loc, parent);
+    RecordDecl *res = new (*this) RecordDecl(*this, name, loc, parent);
     decls.push_back(res);
     return res;
 }
 
 RecordType *AstResource::createRecordType(RecordDecl *decl)
 {
-    RecordType *res = new RecordType(decl);
+    RecordType *res = new (*this) RecordType(decl);
     types.push_back(res);
     return res;
 }
@@ -489,7 +556,7 @@ RecordType *AstResource::createRecordType(RecordDecl *decl)
 RecordType *AstResource::createRecordSubtype(IdentifierInfo *name,
                                              RecordType *base)
 {
-    RecordType *res = new RecordType(base, name);
+    RecordType *res = new (*this) RecordType(base, name);
     types.push_back(res);
     return res;
 }
@@ -497,7 +564,8 @@ RecordType *AstResource::createRecordSubtype(IdentifierInfo *name,
 AccessDecl *AstResource::createAccessDecl(IdentifierInfo *name, Location loc,
                                           Type *targetType, DeclRegion *parent)
 {
-    AccessDecl *result = new AccessDecl(*this, name, loc, targetType, parent);
+    AccessDecl *result = new (*this) AccessDecl(*this, name, loc, targetType,
+                                                parent);
     decls.push_back(result);
     return result;
 }
@@ -507,14 +575,15 @@ AccessDecl *AstResource::createAccessSubtypeDecl(IdentifierInfo *name,
                                                  AccessType *baseType,
                                                  DeclRegion *parent)
 {
-    AccessDecl *result = new AccessDecl(*this, name, loc, baseType, parent);
+    AccessDecl *result = new (*this) AccessDecl(*this, name, loc, baseType,
+                                                parent);
     decls.push_back(result);
     return result;
 }
 
 AccessType *AstResource::createAccessType(AccessDecl *decl, Type *targetType)
 {
-    AccessType *result = new AccessType(decl, targetType);
+    AccessType *result = new (*this) AccessType(decl, targetType);
     types.push_back(result);
     return result;
 }
@@ -522,7 +591,7 @@ AccessType *AstResource::createAccessType(AccessDecl *decl, Type *targetType)
 AccessType *AstResource::createAccessSubtype(IdentifierInfo *name,
                                              AccessType *base)
 {
-    AccessType *result = new AccessType(base, name);
+    AccessType *result = new (*this) AccessType(base, name);
     types.push_back(result);
     return result;
 }
@@ -531,14 +600,15 @@ IncompleteTypeDecl *
 AstResource::createIncompleteTypeDecl(IdentifierInfo *name, Location loc,
                                       DeclRegion *parent)
 {
-    IncompleteTypeDecl *res = new IncompleteTypeDecl(*this, name, loc, parent);
+    IncompleteTypeDecl *res = new (*this) IncompleteTypeDecl(*this, name, loc,
+                                                             parent);
     decls.push_back(res);
     return res;
 }
 
 IncompleteType *AstResource::createIncompleteType(IncompleteTypeDecl *decl)
 {
-    IncompleteType *res = new IncompleteType(decl);
+    IncompleteType *res = new (*this) IncompleteType(decl);
     types.push_back(res);
     return res;
 }
@@ -546,7 +616,7 @@ IncompleteType *AstResource::createIncompleteType(IncompleteTypeDecl *decl)
 IncompleteType *AstResource::createIncompleteSubtype(IdentifierInfo *name,
                                                      IncompleteType *base)
 {
-    IncompleteType *res = new IncompleteType(base, name);
+    IncompleteType *res = new (*this) IncompleteType(base, name);
     types.push_back(res);
     return res;
 }
@@ -556,7 +626,7 @@ ExceptionDecl *AstResource::createExceptionDecl(IdentifierInfo *name,
                                                 DeclRegion *region)
 {
     ExceptionDecl::ExceptionKind ID = ExceptionDecl::User;
-    return new ExceptionDecl(ID, name, loc, region);
+    return new (*this) ExceptionDecl(ID, name, loc, region);
 }
 
 FunctionDecl *
@@ -574,19 +644,19 @@ AstResource::createPrimitiveDecl(PO::PrimitiveID ID, Location loc,
 
     if (ID == PO::POW_op) {
         Type *natural = getTheNaturalType();
-        params.push_back(new ParamValueDecl(
+        params.push_back(new (*this) ParamValueDecl(
                              left, type, PM::MODE_DEFAULT, Location()));
-        params.push_back(new ParamValueDecl(
+        params.push_back(new (*this) ParamValueDecl(
                              right, natural, PM::MODE_DEFAULT, Location()));
     } else if (PO::denotesBinaryOp(ID)) {
-        params.push_back(new ParamValueDecl(
+        params.push_back(new (*this) ParamValueDecl(
                              left, type, PM::MODE_DEFAULT, Location()));
-        params.push_back(new ParamValueDecl(
+        params.push_back(new (*this) ParamValueDecl(
                              right, type, PM::MODE_DEFAULT, Location()));
     }
     else {
         assert(PO::denotesUnaryOp(ID) && "Unexpected operator kind!");
-        params.push_back(new ParamValueDecl(
+        params.push_back(new (*this) ParamValueDecl(
                              right, type, PM::MODE_DEFAULT, Location()));
     }
 
@@ -598,8 +668,23 @@ AstResource::createPrimitiveDecl(PO::PrimitiveID ID, Location loc,
         returnTy = type;
 
     FunctionDecl *op;
-    op = new FunctionDecl(*this, name, loc,
-                          &params[0], params.size(), returnTy, region);
+    op = new (*this) FunctionDecl(*this, name, loc,
+                                  &params[0], params.size(), returnTy, region);
     op->setAsPrimitive(ID);
     return op;
 }
+
+void AstResource::printStats(llvm::raw_ostream &stream) const
+{
+    size_t vectorBytes = decls.capacity() * sizeof(Decl*) +
+        types.capacity() * sizeof(Type*) +
+        nodes.capacity() * sizeof(NodeHeader*);
+
+    stream << "*** AstResource statistics:\n"
+           << "  " << decls.size() << " declarations\n"
+           << "  " << types.size() << " types\n"
+           << "  " << functionTypes.size() << " uniqued function types\n"
+           << "  " << procedureTypes.size() << " uniqued procedure types\n"
+           << "  " << vectorBytes << " bytes in node vectors\n"
+           << "  " << nodeBytes << " bytes allocated from the node arena\n";
+}
@@ -31,7 +31,8 @@ PosAD *PosAD::create(AstResource &resource, IntegerDecl *prefixDecl)
 
     FunctionType *fnTy = resource.getFunctionType(&argType, 1, retType);
 
-    return new PosAD(prefix, name, loc, &key, fnTy, prefixDecl);
+    return new (resource) PosAD(resource, prefix, name, loc,
+                                 &key, fnTy, prefixDecl);
 }
 
 PosAD *PosAD::create(AstResource &resource, EnumerationDecl *prefixDecl)
@@ -48,7 +49,8 @@ PosAD *PosAD::create(AstResource &resource, EnumerationDecl *prefixDecl)
 
     FunctionType *fnTy = resource.getFunctionType(&argType, 1, retType);
 
-    return new PosAD(prefix, name, loc, &key, fnTy, prefixDecl);
+    return new (resource) PosAD(resource, prefix, name, loc,
+                                 &key, fnTy, prefixDecl);
 }
 
 //===----------------------------------------------------------------------===//
@@ -67,7 +69,8 @@ ValAD *ValAD::create(AstResource &resource, IntegerDecl *prefixDecl)
 
     FunctionType *fnTy = resource.getFunctionType(&argType, 1, retType);
 
-    return new ValAD(prefix, name, loc, &key, fnTy, prefixDecl);
+    return new (resource) ValAD(resource, prefix, name, loc,
+                                 &key, fnTy, prefixDecl);
 }
 
 ValAD *ValAD::create(AstResource &resource, EnumerationDecl *prefixDecl)
@@ -84,5 +87,6 @@ ValAD *ValAD::create(AstResource &resource, EnumerationDecl *prefixDecl)
 
     FunctionType *fnTy = resource.getFunctionType(&argType, 1, retType);
 
-    return new ValAD(prefix, name, loc, &key, fnTy, prefixDecl);
+    return new (resource) ValAD(resource, prefix, name, loc,
+                                 &key, fnTy, prefixDecl);
 }
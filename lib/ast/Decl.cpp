@@ -91,11 +91,6 @@ PackageDecl::PackageDecl(AstResource &resource, IdentifierInfo *name,
           privateDeclarations(0),
           instance(0) { }
 
-PackageDecl::~PackageDecl()
-{
-    delete implementation;
-}
-
 void PackageDecl::setImplementation(BodyDecl *body)
 {
     assert(implementation == 0 && "Cannot reset package body!");
@@ -117,7 +112,7 @@ PkgInstanceDecl *PackageDecl::getInstance()
     if (instance)
         return instance;
 
-    instance = new PkgInstanceDecl(getIdInfo(), getLocation(), this);
+    instance = new (resource) PkgInstanceDecl(getIdInfo(), getLocation(), this);
     return instance;
 }
 
@@ -161,7 +156,8 @@ PackageDecl *BodyDecl::getPackage()
 //===----------------------------------------------------------------------===//
 // SubroutineDecl
 
-SubroutineDecl::SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
+SubroutineDecl::SubroutineDecl(AstKind kind, AstResource &resource,
+                               IdentifierInfo *name, Location loc,
                                ParamValueDecl **params, unsigned numParams,
                                DeclRegion *parent)
     : Decl(kind, name, loc, parent),
@@ -175,7 +171,7 @@ SubroutineDecl::SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
     assert(this->denotesSubroutineDecl());
 
     if (numParams > 0)
-        parameters = new ParamValueDecl*[numParams];
+        parameters = resource.allocateArray<ParamValueDecl*>(numParams);
     llvm::SmallVector<const Type*, 8> paramTypes;
 
     for (unsigned i = 0; i < numParams; ++i) {
@@ -185,7 +181,8 @@ SubroutineDecl::SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
     }
 }
 
-SubroutineDecl::SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
+SubroutineDecl::SubroutineDecl(AstKind kind, AstResource &resource,
+                               IdentifierInfo *name, Location loc,
                                IdentifierInfo **keywords, SubroutineType *type,
                                DeclRegion *parent)
     : Decl(kind, name, loc, parent),
@@ -201,10 +198,10 @@ SubroutineDecl::SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
     if (numParameters == 0)
         return;
 
-    parameters = new ParamValueDecl*[numParameters];
+    parameters = resource.allocateArray<ParamValueDecl*>(numParameters);
     for (unsigned i = 0; i < numParameters; ++i) {
         Type *paramType = type->getArgType(i);
-        ParamValueDecl *param = new ParamValueDecl(
+        ParamValueDecl *param = new (resource) ParamValueDecl(
             keywords[i], paramType, PM::MODE_DEFAULT, Location());
         parameters[i] = param;
     }
@@ -223,15 +220,6 @@ SubroutineDecl::SubroutineDecl(AstKind kind, IdentifierInfo *name, Location loc,
     assert(this->denotesSubroutineDecl());
 }
 
-SubroutineDecl::~SubroutineDecl()
-{
-    if (parameters) {
-        for (unsigned i = 0; i < numParameters; ++i)
-            delete parameters[i];
-        delete[] parameters;
-    }
-}
-
 int SubroutineDecl::getKeywordIndex(IdentifierInfo *key) const
 {
     for (unsigned i = 0; i < getArity(); ++i) {
@@ -343,7 +331,7 @@ ProcedureDecl::ProcedureDecl(AstResource &resource,
                              IdentifierInfo *name, Location loc,
                              ParamValueDecl **params, unsigned numParams,
                              DeclRegion *parent)
-    : SubroutineDecl(AST_ProcedureDecl, name, loc,
+    : SubroutineDecl(AST_ProcedureDecl, resource, name, loc,
                      params, numParams, parent)
 {
     // Construct our type.
@@ -361,7 +349,7 @@ FunctionDecl::FunctionDecl(AstResource &resource,
                            IdentifierInfo *name, Location loc,
                            ParamValueDecl **params, unsigned numParams,
                            Type *returnType, DeclRegion *parent)
-    : SubroutineDecl(AST_FunctionDecl, name, loc,
+    : SubroutineDecl(AST_FunctionDecl, resource, name, loc,
                      params, numParams, parent)
 {
     initializeCorrespondingType(resource, returnType);
@@ -516,8 +504,8 @@ EnumerationDecl::EnumerationDecl(AstResource &resource,
     // code, the constraint would be similar to "E'Base'First .. E'Base'Last".
     // Note that these attributes are static expressions.
     EnumerationType *base = root->getBaseSubtype();
-    Expr *lower = new FirstAE(base, Location());
-    Expr *upper = new LastAE(base, Location());
+    Expr *lower = new (resource) FirstAE(base, Location());
+    Expr *upper = new (resource) LastAE(base, Location());
 
     // Construct the subtype.
     EnumerationType *subtype;
@@ -530,7 +518,7 @@ EnumerationDecl::EnumerationDecl(AstResource &resource,
         IdentifierInfo *name = elems[i].first;
         Location loc = elems[i].second;
         EnumLiteral *elem =
-            new EnumLiteral(resource, name, loc, i, subtype, this);
+            new (resource) EnumLiteral(resource, name, loc, i, subtype, this);
         addDecl(elem);
     }
 
@@ -733,7 +721,7 @@ IntegerDecl::IntegerDecl(AstResource &resource,
 
     bits |= Modular_FLAG;
 
-    lowExpr = new IntegerLiteral(lowVal, loc);
+    lowExpr = new (resource) IntegerLiteral(lowVal, loc);
 
     IntegerType *base = resource.createIntegerType(this, lowVal, highVal);
     CorrespondingType = resource.createIntegerSubtype(base, lowVal, highVal);
@@ -906,11 +894,13 @@ RecordDecl::RecordDecl(AstResource &resource, IdentifierInfo *name,
     CorrespondingType = resource.createRecordSubtype(name, base);
 }
 
-ComponentDecl *RecordDecl::addComponent(IdentifierInfo *name, Location loc,
+ComponentDecl *RecordDecl::addComponent(AstResource &resource,
+                                        IdentifierInfo *name, Location loc,
                                         Type *type)
 {
     ComponentDecl *component;
-    component = new ComponentDecl(name, loc, type, componentCount, this);
+    component = new (resource) ComponentDecl(name, loc, type,
+                                             componentCount, this);
     componentCount++;
     addDecl(component);
     return component;
@@ -1036,11 +1026,60 @@ PkgInstanceDecl::PkgInstanceDecl(IdentifierInfo *name, Location loc,
       DeclRegion(AST_PkgInstanceDecl, package),
       definition(package)
 {
-    // Generate our own copy of the public exports provided by the package.
-    //
-    // FIXME: We should use the DeclRegion observer list for this.
+    // Our copies of the public exports provided by the package are generated
+    // on demand.
     AstResource &resource = package->getAstResource();
-    std::auto_ptr<DeclRewriter> rewriter(
-        new DeclRewriter(resource, this, package));
-    addDeclarationsUsingRewrites(*rewriter, package);
+    rewriter = new DeclRewriter(resource, this, package);
+}
+
+PkgInstanceDecl::~PkgInstanceDecl()
+{
+    delete rewriter;
+}
+
+void PkgInstanceDecl::materialize(IdentifierInfo *name)
+{
+    // A name is materialized as a whole, so the presence of a single
+    // declaration with the given name implies all are present.
+    if (isMaterialized() || nameIndex.count(name))
+        return;
+
+    PredRange range = definition->findDecls(name);
+    for (PredIter I = range.first; I != range.second; ++I)
+        addDeclarationUsingRewrites(*rewriter, *I);
+}
+
+void PkgInstanceDecl::materializeLiteral(IdentifierInfo *name)
+{
+    if (isMaterialized())
+        return;
+
+    DeclIter E = definition->endDecls();
+    for (DeclIter I = definition->beginDecls(); I != E; ++I) {
+        if (EnumerationDecl *edecl = dyn_cast<EnumerationDecl>(*I)) {
+            if (edecl->findLiteral(name))
+                materialize(edecl->getIdInfo());
+        }
+    }
+}
+
+void PkgInstanceDecl::materializeAll()
+{
+    if (isMaterialized())
+        return;
+
+    DeclIter E = definition->endDecls();
+    for (DeclIter I = definition->beginDecls(); I != E; ++I)
+        materialize((*I)->getIdInfo());
+
+    // The rewriter is no longer needed.
+    delete rewriter;
+    rewriter = 0;
+}
+
+void PkgInstanceDecl::provideDecls(IdentifierInfo *name) const
+{
+    // Materialization does not change the set of declarations denoted by this
+    // instance, only their representation.
+    const_cast<PkgInstanceDecl*>(this)->materialize(name);
 }
@@ -29,6 +29,7 @@ using llvm::isa;
 void DeclRegion::addDecl(Decl *decl)
 {
     declarations.push_back(decl);
+    nameIndex[decl->getIdInfo()].push_back(decl);
     notifyObserversOfAddition(decl);
 }
 
@@ -49,21 +50,25 @@ DeclRegion::addDeclarationsUsingRewrites(DeclRewriter &rewrites,
 
 Decl *DeclRegion::findDecl(IdentifierInfo *name, Type *type)
 {
-    DeclIter endIter = endDecls();
-    for (DeclIter iter = beginDecls(); iter != endIter; ++iter) {
-        Decl *decl = *iter;
-        if (decl->getIdInfo() == name) {
-            Type *candidate = 0;
-            if (TypeDecl *TD = dyn_cast<TypeDecl>(decl))
-                candidate = TD->getType();
-            else if (SubroutineDecl *SD = dyn_cast<SubroutineDecl>(decl))
-                candidate = SD->getType();
-            else if (ValueDecl *VD = dyn_cast<ValueDecl>(decl))
-                candidate = VD->getType();
-
-            if (candidate && type == candidate)
-                return decl;
-        }
+    provideDecls(name);
+
+    NameIndex::iterator entry = nameIndex.find(name);
+    if (entry == nameIndex.end())
+        return 0;
+
+    DeclChain &chain = entry->second;
+    for (DeclChain::iterator I = chain.begin(); I != chain.end(); ++I) {
+        Decl *decl = *I;
+        Type *candidate = 0;
+        if (TypeDecl *TD = dyn_cast<TypeDecl>(decl))
+            candidate = TD->getType();
+        else if (SubroutineDecl *SD = dyn_cast<SubroutineDecl>(decl))
+            candidate = SD->getType();
+        else if (ValueDecl *VD = dyn_cast<ValueDecl>(decl))
+            candidate = VD->getType();
+
+        if (candidate && type == candidate)
+            return decl;
     }
     return 0;
 }
@@ -71,35 +76,49 @@ Decl *DeclRegion::findDecl(IdentifierInfo *name, Type *type)
 DeclRegion::PredRange
 DeclRegion::findDecls(IdentifierInfo *name) const
 {
-    struct Pred : public PredIter::Predicate {
-        Pred(IdentifierInfo *name) : name(name) { }
-        bool operator()(const Decl *decl) {
-            return decl->getIdInfo() == name;
-        }
-        IdentifierInfo *name;
-    };
-    ConstDeclIter begin = beginDecls();
-    ConstDeclIter end   = endDecls();
-    Pred         *pred  = new Pred(name);
-    return PredRange(PredIter(pred, begin, end), PredIter(end));
+    provideDecls(name);
+
+    NameIndex::const_iterator entry = nameIndex.find(name);
+    if (entry == nameIndex.end())
+        return PredRange(PredIter(0), PredIter(0));
+
+    // The chain holds exactly the declarations with the given name, so no
+    // predicate is needed.
+    const DeclChain &chain = entry->second;
+    PredIter::DeclIter begin = chain.begin();
+    PredIter::DeclIter end   = chain.end();
+    return PredRange(PredIter(0, begin, end), PredIter(end));
 }
 
 bool DeclRegion::removeDecl(Decl *decl)
 {
+    NameIndex::iterator entry = nameIndex.find(decl->getIdInfo());
+    if (entry == nameIndex.end())
+        return false;
+
+    DeclChain &chain = entry->second;
+    DeclChain::iterator link = std::find(chain.begin(), chain.end(), decl);
+    if (link == chain.end())
+        return false;
+
+    chain.erase(link);
+    if (chain.empty())
+        nameIndex.erase(entry);
+
     DeclIter result = std::find(beginDecls(), endDecls(), decl);
-    if (result != endDecls()) {
-        declarations.erase(result);
-        return true;
-    }
-    return false;
+    assert(result != endDecls() && "Name index out of sync!");
+    declarations.erase(result);
+    return true;
 }
 
 bool DeclRegion::containsDecl(const Decl *decl) const
 {
-    ConstDeclIter I = beginDecls();
-    ConstDeclIter E = endDecls();
-    ConstDeclIter P = std::find(I, E, decl);
-    return P != E;
+    NameIndex::const_iterator entry = nameIndex.find(decl->getIdInfo());
+    if (entry == nameIndex.end())
+        return false;
+
+    const DeclChain &chain = entry->second;
+    return std::find(chain.begin(), chain.end(), decl) != chain.end();
 }
 
 bool DeclRegion::collectFunctionDecls(
@@ -175,6 +194,9 @@ void DeclRegion::notifyAddDecl(Decl *decl) { }
 // Default implementation -- do nothing.
 void DeclRegion::notifyRemoveDecl(Decl *decl) { }
 
+// Default implementation -- do nothing.
+void DeclRegion::provideDecls(IdentifierInfo *name) const { }
+
 void DeclRegion::notifyObserversOfAddition(Decl *decl)
 {
     for (ObserverList::iterator iter = observers.begin();
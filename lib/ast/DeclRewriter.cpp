@@ -19,6 +19,8 @@ using llvm::dyn_cast;
 using llvm::cast;
 using llvm::isa;
 
+unsigned DeclRewriter::numRewrittenDecls = 0;
+
 void DeclRewriter::mirrorRegion(DeclRegion *source, DeclRegion *target)
 {
     typedef DeclRegion::DeclIter iterator;
@@ -46,8 +48,194 @@ void DeclRewriter::mirrorRegion(DeclRegion *source, DeclRegion *target)
     }
 }
 
+bool DeclRewriter::isAffected(TypeDecl *decl)
+{
+    AffectedMap::iterator I = affectedDecls.find(decl);
+    if (I != affectedDecls.end())
+        return I->second;
+
+    affectedDecls[decl] = true;
+    bool result = computeAffected(decl);
+    affectedDecls[decl] = result;
+    return result;
+}
+
+bool DeclRewriter::computeAffected(TypeDecl *decl)
+{
+    switch (decl->getKind()) {
+
+    default:
+        return true;
+
+    case Ast::AST_IntegerDecl: {
+        IntegerDecl *idecl = cast<IntegerDecl>(decl);
+        IntegerType *type = idecl->getType();
+
+        if (idecl->isSubtypeDeclaration()) {
+            if (isAffected(type->getAncestorType()))
+                return true;
+            if (!type->isConstrained())
+                return false;
+        }
+        else if (idecl->isModularDeclaration())
+            return isAffected(idecl->getModulusExpr());
+
+        return (isAffected(idecl->getLowBoundExpr()) ||
+                isAffected(idecl->getHighBoundExpr()));
+    }
+
+    case Ast::AST_EnumerationDecl: {
+        EnumerationDecl *edecl = cast<EnumerationDecl>(decl);
+        EnumerationType *type = edecl->getType();
+
+        if (!edecl->isSubtypeDeclaration())
+            return false;
+        if (isAffected(type->getAncestorType()))
+            return true;
+        if (Range *range = type->getConstraint())
+            return (isAffected(range->getLowerBound()) ||
+                    isAffected(range->getUpperBound()));
+        return false;
+    }
+
+    case Ast::AST_ArrayDecl: {
+        ArrayDecl *adecl = cast<ArrayDecl>(decl);
+        if (isAffected(adecl->getComponentType()))
+            return true;
+        for (unsigned i = 0; i < adecl->getRank(); ++i) {
+            if (isAffected(adecl->getIndexType(i)))
+                return true;
+        }
+        return false;
+    }
+
+    case Ast::AST_RecordDecl: {
+        RecordDecl *rdecl = cast<RecordDecl>(decl);
+        for (unsigned i = 0; i < rdecl->numComponents(); ++i) {
+            if (isAffected(rdecl->getComponent(i)->getType()))
+                return true;
+        }
+        return false;
+    }
+
+    case Ast::AST_IncompleteTypeDecl: {
+        IncompleteTypeDecl *ITD = cast<IncompleteTypeDecl>(decl);
+        return ITD->hasCompletion() && isAffected(ITD->getCompletion());
+    }
+
+    case Ast::AST_AccessDecl: {
+        AccessDecl *access = cast<AccessDecl>(decl);
+        return isAffected(access->getType()->getTargetType());
+    }
+
+    case Ast::AST_PrivateTypeDecl:
+        return isAffected(cast<PrivateTypeDecl>(decl)->getCompletion());
+    }
+}
+
+bool DeclRewriter::isAffected(Type *type)
+{
+    if (AstRewriter::findRewrite(type))
+        return true;
+
+    if (SubroutineType *srType = dyn_cast<SubroutineType>(type)) {
+        if (FunctionType *ftype = dyn_cast<FunctionType>(srType)) {
+            if (isAffected(ftype->getReturnType()))
+                return true;
+        }
+        for (unsigned i = 0; i < srType->getArity(); ++i) {
+            if (isAffected(srType->getArgType(i)))
+                return true;
+        }
+        return false;
+    }
+
+    // Types declared outside of the origin are only affected by explicit
+    // rewrite rules.
+    TypeDecl *decl = 0;
+    if (DiscreteType *discrete = dyn_cast<DiscreteType>(type))
+        decl = discrete->getDefiningDecl();
+    else if (ArrayType *array = dyn_cast<ArrayType>(type))
+        decl = array->getDefiningDecl();
+    else if (RecordType *record = dyn_cast<RecordType>(type))
+        decl = record->getDefiningDecl();
+    else if (AccessType *access = dyn_cast<AccessType>(type))
+        decl = access->getDefiningDecl();
+    else if (IncompleteType *incomplete = dyn_cast<IncompleteType>(type))
+        decl = incomplete->getDefiningDecl();
+    else if (PrivateType *ptype = dyn_cast<PrivateType>(type))
+        decl = ptype->getDefiningDecl();
+
+    return decl && decl->getDeclRegion() == origin && isAffected(decl);
+}
+
+bool DeclRewriter::isAffected(Expr *expr)
+{
+    if (isAffected(expr->getType()))
+        return true;
+
+    switch (expr->getKind()) {
+
+    default:
+        if (ScalarBoundAE *bound = dyn_cast<ScalarBoundAE>(expr))
+            return isAffected(bound->getPrefix());
+        if (LengthAE *length = dyn_cast<LengthAE>(expr)) {
+            Expr *prefix = length->getPrefixExpr();
+            if (!prefix || isAffected(prefix))
+                return true;
+            return (!length->hasImplicitDimension() &&
+                    isAffected(length->getDimensionExpr()));
+        }
+        if (ArrayBoundAE *bound = dyn_cast<ArrayBoundAE>(expr)) {
+            if (isAffected(bound->getPrefix()))
+                return true;
+            return (!bound->hasImplicitDimension() &&
+                    isAffected(bound->getDimensionExpr()));
+        }
+        return true;
+
+    case Ast::AST_FunctionCallExpr: {
+        FunctionCallExpr *call = cast<FunctionCallExpr>(expr);
+        Decl *connective = call->getConnective();
+        Decl *rewrite = findRewrite(connective);
+        if (rewrite && rewrite != connective)
+            return true;
+
+        FunctionCallExpr::arg_iterator I = call->begin_arguments();
+        FunctionCallExpr::arg_iterator E = call->end_arguments();
+        for ( ; I != E; ++I) {
+            if (isAffected(*I))
+                return true;
+        }
+        return false;
+    }
+
+    case Ast::AST_IntegerLiteral:
+        return false;
+
+    case Ast::AST_ConversionExpr:
+        return isAffected(cast<ConversionExpr>(expr)->getOperand());
+    }
+}
+
+TypeDecl *DeclRewriter::findOrShareDecl(TypeDecl *decl)
+{
+    if (Decl *result = findRewrite(decl))
+        return cast<TypeDecl>(result);
+
+    if (isAffected(decl))
+        return 0;
+
+    addDeclRewrite(decl, decl);
+    return decl;
+}
+
 FunctionDecl *DeclRewriter::rewriteFunctionDecl(FunctionDecl *fdecl)
 {
+    if (Decl *rewrite = findRewrite(fdecl))
+        return cast<FunctionDecl>(rewrite);
+
+    AstResource &resource = getAstResource();
     llvm::SmallVector<ParamValueDecl*, 8> params;
     unsigned arity = fdecl->getArity();
 
@@ -55,24 +243,29 @@ FunctionDecl *DeclRewriter::rewriteFunctionDecl(FunctionDecl *fdecl)
         ParamValueDecl *origParam = fdecl->getParam(i);
         Type *newType = rewriteType(origParam->getType());
         ParamValueDecl *newParam =
-            new ParamValueDecl(origParam->getIdInfo(), newType,
-                               origParam->getExplicitParameterMode(),
-                               Location());
+            new (resource) ParamValueDecl(origParam->getIdInfo(), newType,
+                                          origParam->getExplicitParameterMode(),
+                                          Location());
         params.push_back(newParam);
     }
 
     FunctionDecl *result =
-        new FunctionDecl(getAstResource(),
-                         fdecl->getIdInfo(), fdecl->getLocation(),
-                         params.data(), arity,
-                         rewriteType(fdecl->getReturnType()), context);
+        new (resource) FunctionDecl(resource,
+                                    fdecl->getIdInfo(), fdecl->getLocation(),
+                                    params.data(), arity,
+                                    rewriteType(fdecl->getReturnType()),
+                                    context);
     result->setOrigin(fdecl);
-    addDeclRewrite(fdecl, result);
+    addNewDecl(fdecl, result);
     return result;
 }
 
 ProcedureDecl *DeclRewriter::rewriteProcedureDecl(ProcedureDecl *pdecl)
 {
+    if (Decl *rewrite = findRewrite(pdecl))
+        return cast<ProcedureDecl>(rewrite);
+
+    AstResource &resource = getAstResource();
     llvm::SmallVector<ParamValueDecl*, 8> params;
     unsigned arity = pdecl->getArity();
 
@@ -80,24 +273,27 @@ ProcedureDecl *DeclRewriter::rewriteProcedureDecl(ProcedureDecl *pdecl)
         ParamValueDecl *origParam = pdecl->getParam(i);
         Type *newType = rewriteType(origParam->getType());
         ParamValueDecl *newParam =
-            new ParamValueDecl(origParam->getIdInfo(), newType,
-                               origParam->getExplicitParameterMode(),
-                               origParam->getLocation());
+            new (resource) ParamValueDecl(origParam->getIdInfo(), newType,
+                                          origParam->getExplicitParameterMode(),
+                                          origParam->getLocation());
         params.push_back(newParam);
     }
 
     ProcedureDecl *result =
-        new ProcedureDecl(getAstResource(),
-                          pdecl->getIdInfo(), pdecl->getLocation(),
-                          params.data(), arity, context);
+        new (resource) ProcedureDecl(resource,
+                                     pdecl->getIdInfo(), pdecl->getLocation(),
+                                     params.data(), arity, context);
     result->setOrigin(pdecl);
-    addDeclRewrite(pdecl, result);
+    addNewDecl(pdecl, result);
     return result;
 }
 
 EnumerationDecl *
 DeclRewriter::rewriteEnumerationDecl(EnumerationDecl *edecl)
 {
+    if (TypeDecl *shared = findOrShareDecl(edecl))
+        return cast<EnumerationDecl>(shared);
+
     typedef std::pair<IdentifierInfo*, Location> Pair;
 
     AstResource &resource = getAstResource();
@@ -146,7 +342,7 @@ DeclRewriter::rewriteEnumerationDecl(EnumerationDecl *edecl)
     result->setOrigin(edecl);
 
     // Inject rewrite rules mapping the old enumeration to the new.
-    addDeclRewrite(edecl, result);
+    addNewDecl(edecl, result);
     addTypeRewrite(edecl->getType(), result->getType());
     mirrorRegion(edecl, result);
     return result;
@@ -154,11 +350,15 @@ DeclRewriter::rewriteEnumerationDecl(EnumerationDecl *edecl)
 
 ArrayDecl *DeclRewriter::rewriteArrayDecl(ArrayDecl *adecl)
 {
+    if (TypeDecl *shared = findOrShareDecl(adecl))
+        return cast<ArrayDecl>(shared);
+
     IdentifierInfo *name = adecl->getIdInfo();
     unsigned rank = adecl->getRank();
     bool isConstrained = adecl->isConstrained();
     Type *component = rewriteType(adecl->getComponentType());
     llvm::SmallVector<DSTDefinition*, 16> indices(rank);
+    AstResource &resource = getAstResource();
 
     for (unsigned i = 0; i < rank; ++i) {
         // Just rewrite the index types into DSTDef's with the Type_DST tag.
@@ -170,11 +370,11 @@ ArrayDecl *DeclRewriter::rewriteArrayDecl(ArrayDecl *adecl)
         DiscreteType *indexTy;
         Location loc = adecl->getDSTDefinition(i)->getLocation();
         indexTy = cast<DiscreteType>(rewriteType(adecl->getIndexType(i)));
-        indices[i] = new DSTDefinition(loc, indexTy, DSTDefinition::Type_DST);
+        indices[i] = new (resource) DSTDefinition(loc, indexTy,
+                                                  DSTDefinition::Type_DST);
     }
 
     ArrayDecl *result;
-    AstResource &resource = getAstResource();
     result = resource.createArrayDecl(name, adecl->getLocation(),
                                       rank, &indices[0],
                                       component, isConstrained, context);
@@ -182,13 +382,16 @@ ArrayDecl *DeclRewriter::rewriteArrayDecl(ArrayDecl *adecl)
 
     /// FIXME:  Array types will eventually have primitive operations defined on
     /// them.  Generate and mirror the results.
-    addDeclRewrite(adecl, result);
+    addNewDecl(adecl, result);
     addTypeRewrite(adecl->getType(), result->getType());
     return result;
 }
 
 IntegerDecl *DeclRewriter::rewriteIntegerDecl(IntegerDecl *idecl)
 {
+    if (TypeDecl *shared = findOrShareDecl(idecl))
+        return cast<IntegerDecl>(shared);
+
     IdentifierInfo *name = idecl->getIdInfo();
     Location loc = idecl->getLocation();
 
@@ -231,20 +434,20 @@ IntegerDecl *DeclRewriter::rewriteIntegerDecl(IntegerDecl *idecl)
     addTypeRewrite(sourceTy->getRootType()->getBaseSubtype(),
                    targetTy->getRootType()->getBaseSubtype());
 
-    addDeclRewrite(idecl, result);
+    addNewDecl(idecl, result);
     mirrorRegion(idecl, result);
     return result;
 }
 
 RecordDecl *DeclRewriter::rewriteRecordDecl(RecordDecl *decl)
 {
-    RecordDecl *result;
-    if ((result = cast_or_null<RecordDecl>(findRewrite(decl))))
-        return result;
+    if (TypeDecl *shared = findOrShareDecl(decl))
+        return cast<RecordDecl>(shared);
 
     IdentifierInfo *name = decl->getIdInfo();
     AstResource &resource = getAstResource();
-    result = resource.createRecordDecl(name, decl->getLocation(), context);
+    RecordDecl *result =
+        resource.createRecordDecl(name, decl->getLocation(), context);
 
     typedef DeclRegion::DeclIter decl_iterator;
     decl_iterator I = decl->beginDecls();
@@ -254,31 +457,33 @@ RecordDecl *DeclRewriter::rewriteRecordDecl(RecordDecl *decl)
             IdentifierInfo *componentID = orig->getIdInfo();
             Location componentLoc = orig->getLocation();
             Type *componentTy = rewriteType(orig->getType());
-            result->addComponent(componentID, componentLoc, componentTy);
+            result->addComponent(resource, componentID,
+                                 componentLoc, componentTy);
         }
     }
 
     // Provide mappings from the original first subtype to the new subtype.
     addTypeRewrite(decl->getType(), result->getType());
-    addDeclRewrite(decl, result);
+    addNewDecl(decl, result);
     return result;
 }
 
 IncompleteTypeDecl *
 DeclRewriter::rewriteIncompleteTypeDecl(IncompleteTypeDecl *ITD)
 {
-    IncompleteTypeDecl *result;
-    if ((result = cast_or_null<IncompleteTypeDecl>(findRewrite(ITD))))
-        return result;
+    if (TypeDecl *shared = findOrShareDecl(ITD))
+        return cast<IncompleteTypeDecl>(shared);
 
     IdentifierInfo *name = ITD->getIdInfo();
     Location loc = ITD->getLocation();
-    result = getAstResource().createIncompleteTypeDecl(name, loc, context);
+    AstResource &resource = getAstResource();
+    IncompleteTypeDecl *result =
+        resource.createIncompleteTypeDecl(name, loc, context);
 
     // Provide a mapping from the original declaration to the new one.  We do
     // this before rewriting the completion (if any) to avoid circularites.
     addTypeRewrite(ITD->getType(), result->getType());
-    addDeclRewrite(ITD, result);
+    addNewDecl(ITD, result);
 
     // The new incomplete type declaration does not have a completion.  If the
     // given ITD has a completion rewrite it as well.
@@ -293,8 +498,8 @@ DeclRewriter::rewriteIncompleteTypeDecl(IncompleteTypeDecl *ITD)
 AccessDecl *DeclRewriter::rewriteAccessDecl(AccessDecl *access)
 {
     AccessDecl *result;
-    if ((result = cast_or_null<AccessDecl>(findRewrite(access))))
-        return result;
+    if (TypeDecl *shared = findOrShareDecl(access))
+        return cast<AccessDecl>(shared);
 
     AstResource &resource = getAstResource();
     IdentifierInfo *name = access->getIdInfo();
@@ -318,27 +523,27 @@ AccessDecl *DeclRewriter::rewriteAccessDecl(AccessDecl *access)
     result->generateImplicitDeclarations(resource);
     result->setOrigin(access);
     addTypeRewrite(access->getType(), result->getType());
-    addDeclRewrite(access, result);
+    addNewDecl(access, result);
     mirrorRegion(access, result);
     return result;
 }
 
 PrivateTypeDecl *DeclRewriter::rewritePrivateTypeDecl(PrivateTypeDecl *pdecl)
 {
-    PrivateTypeDecl *result;
-    if ((result = cast_or_null<PrivateTypeDecl>(findRewrite(pdecl))))
-        return result;
+    if (TypeDecl *shared = findOrShareDecl(pdecl))
+        return cast<PrivateTypeDecl>(shared);
 
     AstResource &resource = getAstResource();
     IdentifierInfo *name = pdecl->getIdInfo();
     Location loc = pdecl->getLocation();
     unsigned tags = pdecl->getTypeTags();
 
-    result = new PrivateTypeDecl(resource, name, loc, tags, context);
+    PrivateTypeDecl *result =
+        new (resource) PrivateTypeDecl(resource, name, loc, tags, context);
     result->setOrigin(pdecl);
     result->generateImplicitDeclarations(resource);
     addTypeRewrite(pdecl->getType(), result->getType());
-    addDeclRewrite(pdecl, result);
+    addNewDecl(pdecl, result);
     mirrorRegion(pdecl, result);
     result->setCompletion(rewriteTypeDecl(pdecl->getCompletion()));
     return result;
@@ -419,6 +624,12 @@ Type *DeclRewriter::rewriteType(Type *type)
     switch (type->getKind()) {
 
     default:
+        // Discrete and private types are rewritten thru the rules installed
+        // when their declaration is rewritten.  Declarations are not
+        // necessarily rewritten in order, so ensure any declaration in the
+        // origin has been visited.
+        if (TypeDecl *decl = getOriginDecl(type))
+            rewriteTypeDecl(decl);
         result = AstRewriter::rewriteType(type);
         break;
 
@@ -441,6 +652,19 @@ Type *DeclRewriter::rewriteType(Type *type)
     return result;
 }
 
+TypeDecl *DeclRewriter::getOriginDecl(Type *type)
+{
+    TypeDecl *decl = 0;
+    if (DiscreteType *discrete = dyn_cast<DiscreteType>(type))
+        decl = discrete->getDefiningDecl();
+    else if (PrivateType *ptype = dyn_cast<PrivateType>(type))
+        decl = ptype->getDefiningDecl();
+
+    if (decl && decl->getDeclRegion() == origin)
+        return decl;
+    return 0;
+}
+
 AccessType *DeclRewriter::rewriteAccessType(AccessType *type)
 {
     AccessDecl *declaration = type->getDefiningDecl();
@@ -477,7 +701,8 @@ IntegerLiteral *DeclRewriter::rewriteIntegerLiteral(IntegerLiteral *lit)
 {
     IntegerType *targetTy = cast<IntegerType>(rewriteType(lit->getType()));
     const llvm::APInt &value = lit->getValue();
-    return new IntegerLiteral(value, targetTy, lit->getLocation());
+    AstResource &resource = getAstResource();
+    return new (resource) IntegerLiteral(value, targetTy, lit->getLocation());
 }
 
 FunctionCallExpr *
@@ -498,22 +723,25 @@ DeclRewriter::rewriteFunctionCall(FunctionCallExpr *call)
     for (unsigned idx = 0; I != E; ++I, ++idx)
         args[idx] = rewriteExpr(*I);
 
-    return new FunctionCallExpr(connective, loc, args.data(), numArgs, 0, 0);
+    AstResource &resource = getAstResource();
+    return new (resource) FunctionCallExpr(resource, connective, loc,
+                                           args.data(), numArgs, 0, 0);
 }
 
 AttribExpr *DeclRewriter::rewriteAttrib(AttribExpr *attrib)
 {
     AttribExpr *result = 0;
     Location loc = attrib->getLocation();
+    AstResource &resource = getAstResource();
 
     if (ScalarBoundAE *bound = dyn_cast<ScalarBoundAE>(attrib)) {
         IntegerType *prefix;
         prefix = cast<IntegerType>(rewriteType(bound->getPrefix()));
 
         if (bound->isFirst())
-            result = new FirstAE(prefix, loc);
+            result = new (resource) FirstAE(prefix, loc);
         else
-            result = new LastAE(prefix, loc);
+            result = new (resource) LastAE(prefix, loc);
     }
     else if (LengthAE *length = dyn_cast<LengthAE>(attrib)) {
         // FIXME: Support array subtype prefix.
@@ -522,10 +750,10 @@ AttribExpr *DeclRewriter::rewriteAttrib(AttribExpr *attrib)
 
         prefix = rewriteExpr(prefix);
         if (length->hasImplicitDimension())
-            result = new LengthAE(prefix, loc);
+            result = new (resource) LengthAE(prefix, loc);
         else {
             Expr *dimension = rewriteExpr(length->getDimensionExpr());
-            result = new LengthAE(prefix, loc, dimension);
+            result = new (resource) LengthAE(prefix, loc, dimension);
         }
     }
     else {
@@ -534,16 +762,16 @@ AttribExpr *DeclRewriter::rewriteAttrib(AttribExpr *attrib)
 
         if (bound->hasImplicitDimension()) {
             if (bound->isFirst())
-                result = new FirstArrayAE(prefix, loc);
+                result = new (resource) FirstArrayAE(prefix, loc);
             else
-                result = new LastArrayAE(prefix, loc);
+                result = new (resource) LastArrayAE(prefix, loc);
         }
         else {
             Expr *dim = rewriteExpr(bound->getDimensionExpr());
             if (bound->isFirst())
-                result = new FirstArrayAE(prefix, dim, loc);
+                result = new (resource) FirstArrayAE(prefix, dim, loc);
             else
-                result = new LastArrayAE(prefix, dim, loc);
+                result = new (resource) LastArrayAE(prefix, dim, loc);
         }
     }
     return result;
@@ -555,7 +783,8 @@ ConversionExpr *DeclRewriter::rewriteConversion(ConversionExpr *conv)
     Type *targetTy = rewriteType(conv->getType());
     Location loc = conv->getLocation();
     bool isImplicit = conv->isImplicit();
-    return new ConversionExpr(operand, targetTy, loc, isImplicit);
+    AstResource &resource = getAstResource();
+    return new (resource) ConversionExpr(operand, targetTy, loc, isImplicit);
 }
 
 Expr *DeclRewriter::rewriteExpr(Expr *expr)
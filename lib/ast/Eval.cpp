@@ -30,16 +30,19 @@ namespace {
 /// \param result If \p expr was successfully evaluated, \p result is set to the
 /// computed value.
 ///
+/// \param settled Set to false if the outcome depends on subexpressions
+/// whose types are not yet resolved.
+///
 /// \return True if \p expr was static and \p result was set. False otherwise.
 bool staticDiscreteFunctionValue(const FunctionCallExpr *expr,
-                                 llvm::APInt &result);
+                                 llvm::APInt &result, bool &settled);
 
 /// Helper for staticDiscreteFunctionValue.
 ///
 /// Attepmts to evaluate the given function call expression using an attribute
 /// connective.
 bool staticDiscreteFunctionAttribValue(const FunctionCallExpr *expr,
-                                       llvm::APInt &result);
+                                       llvm::APInt &result, bool &settled);
 
 /// Attempts to evaluate a Pos attribute staticly.
 ///
@@ -53,7 +56,7 @@ bool staticDiscreteFunctionAttribValue(const FunctionCallExpr *expr,
 /// \return True if the attribute was static and \p result was set.  False
 /// otherwise.
 bool staticDiscretePosAttribValue(const DiscreteType *prefix, const Expr *arg,
-                                  llvm::APInt &result);
+                                  llvm::APInt &result, bool &settled);
 
 /// Attempts to evaluate a Val attribute staticly.
 ///
@@ -67,7 +70,7 @@ bool staticDiscretePosAttribValue(const DiscreteType *prefix, const Expr *arg,
 /// \return True if the attribute was static and \p result was set.  False
 /// otherwise.
 bool staticDiscreteValAttribValue(const DiscreteType *prefix, const Expr *arg,
-                                  llvm::APInt &result);
+                                  llvm::APInt &result, bool &settled);
 
 /// Attempts to evaluate a static, unary, discrete valued function call.
 ///
@@ -79,8 +82,8 @@ bool staticDiscreteValAttribValue(const DiscreteType *prefix, const Expr *arg,
 /// computed value.
 ///
 /// \return True if \p arg was static and \p result was set.  False otherwise.
-bool staticDiscreteUnaryValue(PO::PrimitiveID ID,
-                             const Expr *expr, llvm::APInt &result);
+bool staticDiscreteUnaryValue(PO::PrimitiveID ID, const Expr *expr,
+                              llvm::APInt &result, bool &settled);
 
 /// Attempts to evaluate a static, binary, discrete valued function call.
 ///
@@ -96,7 +99,7 @@ bool staticDiscreteUnaryValue(PO::PrimitiveID ID,
 /// \return True if the evaluation was successful.
 bool staticDiscreteBinaryValue(PO::PrimitiveID ID,
                                const Expr *x, const Expr *y,
-                               llvm::APInt &result);
+                               llvm::APInt &result, bool &settled);
 
 /// Attempts to evaluate a static discrete valued attribute expression.
 ///
@@ -152,25 +155,25 @@ llvm::APInt exponentiate(llvm::APInt x, llvm::APInt y);
 // Implementations.
 
 bool staticDiscreteFunctionValue(const FunctionCallExpr *expr,
-                                 llvm::APInt &result)
+                                 llvm::APInt &result, bool &settled)
 {
     PO::PrimitiveID ID = getCallPrimitive(expr);
 
     if (ID == PO::NotPrimitive)
-        return staticDiscreteFunctionAttribValue(expr, result);
+        return staticDiscreteFunctionAttribValue(expr, result, settled);
 
     typedef FunctionCallExpr::const_arg_iterator iterator;
     iterator I = expr->begin_arguments();
     if (PO::denotesUnaryOp(ID)) {
         assert(expr->getNumArgs() == 1);
         const Expr *arg = *I;
-        return staticDiscreteUnaryValue(ID, arg, result);
+        return staticDiscreteUnaryValue(ID, arg, result, settled);
     }
     else if (PO::denotesBinaryOp(ID)) {
         assert(expr->getNumArgs() == 2);
         const Expr *lhs = *I;
         const Expr *rhs = *(++I);
-        return staticDiscreteBinaryValue(ID, lhs, rhs, result);
+        return staticDiscreteBinaryValue(ID, lhs, rhs, result, settled);
     }
     else if (ID == PO::ENUM_op) {
         const EnumLiteral *lit = cast<EnumLiteral>(expr->getConnective());
@@ -186,7 +189,7 @@ bool staticDiscreteFunctionValue(const FunctionCallExpr *expr,
 }
 
 bool staticDiscreteFunctionAttribValue(const FunctionCallExpr *expr,
-                                       llvm::APInt &result)
+                                       llvm::APInt &result, bool &settled)
 {
     bool success = false;
     const FunctionAttribDecl *decl;
@@ -205,14 +208,14 @@ bool staticDiscreteFunctionAttribValue(const FunctionCallExpr *expr,
     case Ast::AST_PosAD: {
         const PosAD *attrib = cast<PosAD>(decl);
         success = staticDiscretePosAttribValue
-            (attrib->getPrefix(), *expr->begin_arguments(), result);
+            (attrib->getPrefix(), *expr->begin_arguments(), result, settled);
         break;
     }
 
     case Ast::AST_ValAD: {
         const ValAD *attrib = cast<ValAD>(decl);
         success = staticDiscreteValAttribValue
-            (attrib->getPrefix(), *expr->begin_arguments(), result);
+            (attrib->getPrefix(), *expr->begin_arguments(), result, settled);
     }
     };
 
@@ -220,7 +223,7 @@ bool staticDiscreteFunctionAttribValue(const FunctionCallExpr *expr,
 }
 
 bool staticDiscretePosAttribValue(const DiscreteType *prefix, const Expr *arg,
-                                  llvm::APInt &result)
+                                  llvm::APInt &result, bool &settled)
 {
     llvm::APInt lower;
     llvm::APInt pos;
@@ -236,7 +239,7 @@ bool staticDiscretePosAttribValue(const DiscreteType *prefix, const Expr *arg,
         prefix->getLowerLimit(lower);
 
     // Attempt to evaluate the argument.
-    if (!arg->staticDiscreteValue(pos))
+    if (!arg->staticDiscreteValue(pos, settled))
         return false;
 
     // The position of the argument is its value minus the lower limit.
@@ -245,7 +248,7 @@ bool staticDiscretePosAttribValue(const DiscreteType *prefix, const Expr *arg,
 }
 
 bool staticDiscreteValAttribValue(const DiscreteType *prefix, const Expr *arg,
-                                  llvm::APInt &result)
+                                  llvm::APInt &result, bool &settled)
 {
     llvm::APInt lower;
     llvm::APInt val;
@@ -261,7 +264,7 @@ bool staticDiscreteValAttribValue(const DiscreteType *prefix, const Expr *arg,
         prefix->getLowerLimit(lower);
 
     // Attempt to evaluate the argument.
-    if (!arg->staticDiscreteValue(val))
+    if (!arg->staticDiscreteValue(val, settled))
         return false;
 
     // The value of this attribute is the position number plus the lower limit.
@@ -271,10 +274,11 @@ bool staticDiscreteValAttribValue(const DiscreteType *prefix, const Expr *arg,
 
 bool staticDiscreteBinaryValue(PO::PrimitiveID ID,
                                const Expr *x, const Expr *y,
-                               llvm::APInt &result)
+                               llvm::APInt &result, bool &settled)
 {
     llvm::APInt LHS, RHS;
-    if (!x->staticDiscreteValue(LHS) || !y->staticDiscreteValue(RHS))
+    if (!x->staticDiscreteValue(LHS, settled) ||
+        !y->staticDiscreteValue(RHS, settled))
         return false;
 
     switch (ID) {
@@ -302,9 +306,9 @@ bool staticDiscreteBinaryValue(PO::PrimitiveID ID,
 }
 
 bool staticDiscreteUnaryValue(PO::PrimitiveID ID, const Expr *arg,
-                              llvm::APInt &result)
+                              llvm::APInt &result, bool &settled)
 {
-    if (!arg->staticDiscreteValue(result))
+    if (!arg->staticDiscreteValue(result, settled))
         return false;
 
     // There are only two unary operations to consider.  Negation and the
@@ -436,21 +440,49 @@ llvm::APInt exponentiate(llvm::APInt x, llvm::APInt y)
 
 bool Expr::staticDiscreteValue(llvm::APInt &result) const
 {
-    if (const IntegerLiteral *ILit = dyn_cast<IntegerLiteral>(this)) {
-        result = ILit->getValue();
+    bool settled = true;
+    return staticDiscreteValue(result, settled);
+}
+
+bool Expr::staticDiscreteValue(llvm::APInt &result, bool &settled) const
+{
+    switch (staticState) {
+    case STATIC_UNKNOWN:
+        break;
+    case STATIC_VALUE:
+        result = llvm::APInt(staticWidth, staticValue, true);
         return true;
+    case STATIC_NONE:
+        return false;
     }
 
-    if (const FunctionCallExpr *FCall = dyn_cast<FunctionCallExpr>(this))
-        return staticDiscreteFunctionValue(FCall, result);
+    // The outcome of the evaluation is final only if this expression and all
+    // subexpressions consulted have resolved types.  Universal literals are
+    // widened in place and ambiguous calls resolved as type checking proceeds.
+    bool isSettled = hasResolvedType();
+    bool isStatic = false;
 
-    if (const ConversionExpr *CExpr = dyn_cast<ConversionExpr>(this))
-        return CExpr->getOperand()->staticDiscreteValue(result);
-
-    if (const AttribExpr *AExpr = dyn_cast<AttribExpr>(this))
-        return staticDiscreteAttribExpr(AExpr, result);
-
-    return false;
+    if (const IntegerLiteral *ILit = dyn_cast<IntegerLiteral>(this)) {
+        result = ILit->getValue();
+        isStatic = true;
+    }
+    else if (const FunctionCallExpr *FCall = dyn_cast<FunctionCallExpr>(this))
+        isStatic = staticDiscreteFunctionValue(FCall, result, isSettled);
+    else if (const ConversionExpr *CExpr = dyn_cast<ConversionExpr>(this))
+        isStatic = CExpr->getOperand()->staticDiscreteValue(result, isSettled);
+    else if (const AttribExpr *AExpr = dyn_cast<AttribExpr>(this))
+        isStatic = staticDiscreteAttribExpr(AExpr, result);
+
+    if (!isSettled)
+        settled = false;
+    else if (!isStatic)
+        staticState = STATIC_NONE;
+    else if (result.getBitWidth() <= 64) {
+        staticState = STATIC_VALUE;
+        staticWidth = result.getBitWidth();
+        staticValue = result.getSExtValue();
+    }
+    return isStatic;
 }
 
 bool Expr::isStaticDiscreteExpr() const
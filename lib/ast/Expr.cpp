@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "comma/ast/AstResource.h"
 #include "comma/ast/AttribExpr.h"
 #include "comma/ast/Expr.h"
 #include "comma/ast/KeywordSelector.h"
@@ -128,34 +129,38 @@ bool Expr::denotesName() const
 //===----------------------------------------------------------------------===//
 // FunctionCallExpr
 
-FunctionCallExpr::FunctionCallExpr(SubroutineRef *connective,
+FunctionCallExpr::FunctionCallExpr(AstResource &resource,
+                                   SubroutineRef *connective,
                                    Expr **posArgs, unsigned numPos,
                                    KeywordSelector **keyArgs, unsigned numKeys)
     : Expr(AST_FunctionCallExpr, connective->getLocation()),
-      SubroutineCall(connective, posArgs, numPos, keyArgs, numKeys)
+      SubroutineCall(resource, connective, posArgs, numPos, keyArgs, numKeys)
 {
     setTypeForConnective();
 }
 
-FunctionCallExpr::FunctionCallExpr(FunctionDecl *connective, Location loc,
+FunctionCallExpr::FunctionCallExpr(AstResource &resource,
+                                   FunctionDecl *connective, Location loc,
                                    Expr **posArgs, unsigned numPos,
                                    KeywordSelector **keyArgs, unsigned numKeys)
     : Expr(AST_FunctionCallExpr, loc),
-      SubroutineCall(connective, posArgs, numPos, keyArgs, numKeys)
+      SubroutineCall(resource, connective, posArgs, numPos, keyArgs, numKeys)
 {
     setTypeForConnective();
 }
 
-FunctionCallExpr::FunctionCallExpr(SubroutineRef *connective)
+FunctionCallExpr::FunctionCallExpr(AstResource &resource,
+                                   SubroutineRef *connective)
     : Expr(AST_FunctionCallExpr, connective->getLocation()),
-      SubroutineCall(connective, 0, 0, 0, 0)
+      SubroutineCall(resource, connective, 0, 0, 0, 0)
 {
     setTypeForConnective();
 }
 
-FunctionCallExpr::FunctionCallExpr(FunctionDecl *connective, Location loc)
+FunctionCallExpr::FunctionCallExpr(AstResource &resource,
+                                   FunctionDecl *connective, Location loc)
     : Expr(AST_FunctionCallExpr, loc),
-      SubroutineCall(connective, 0, 0, 0, 0)
+      SubroutineCall(resource, connective, 0, 0, 0, 0)
 {
     setTypeForConnective();
 }
@@ -177,7 +182,7 @@ void FunctionCallExpr::resolveConnective(FunctionDecl *decl)
 //===----------------------------------------------------------------------===//
 // IndexedArrayExpr
 
-IndexedArrayExpr::IndexedArrayExpr(Expr *arrExpr,
+IndexedArrayExpr::IndexedArrayExpr(AstResource &resource, Expr *arrExpr,
                                    Expr **indices, unsigned numIndices)
     : Expr(AST_IndexedArrayExpr, arrExpr->getLocation()),
       indexedArray(arrExpr),
@@ -190,16 +195,17 @@ IndexedArrayExpr::IndexedArrayExpr(Expr *arrExpr,
         setType(arrTy->getComponentType());
     }
 
-    indexExprs = new Expr*[numIndices];
+    indexExprs = resource.allocateArray<Expr*>(numIndices);
     std::copy(indices, indices + numIndices, indexExprs);
 }
 
 //===----------------------------------------------------------------------===//
 // StringLiteral
 
-void StringLiteral::init(const char *string, unsigned len)
+void StringLiteral::init(AstResource &resource,
+                         const char *string, unsigned len)
 {
-    this->rep = new char[len];
+    this->rep = resource.allocateArray<char>(len);
     this->len = len;
     std::strncpy(this->rep, string, len);
 }
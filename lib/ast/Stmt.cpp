@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "comma/ast/AstResource.h"
 #include "comma/ast/DSTDefinition.h"
 #include "comma/ast/ExceptionRef.h"
 #include "comma/ast/Expr.h"
@@ -61,11 +62,12 @@ bool StmtSequence::handles(const ExceptionDecl *exception) const
 
 //===----------------------------------------------------------------------===//
 // HandlerStmt
-HandlerStmt::HandlerStmt(Location loc, ExceptionRef **refs, unsigned numRefs)
+HandlerStmt::HandlerStmt(AstResource &resource, Location loc,
+                         ExceptionRef **refs, unsigned numRefs)
     : StmtSequence(AST_HandlerStmt, loc),
       numChoices(numRefs)
 {
-    choices = new ExceptionRef*[numChoices];
+    choices = resource.allocateArray<ExceptionRef*>(numChoices);
     std::memcpy(choices, refs, sizeof(ExceptionRef*)*numRefs);
 }
 
@@ -81,22 +83,16 @@ bool HandlerStmt::handles(const ExceptionDecl *exception) const
 
 //===----------------------------------------------------------------------===//
 // ProcedureCallStmt
-ProcedureCallStmt::ProcedureCallStmt(SubroutineRef *ref,
+ProcedureCallStmt::ProcedureCallStmt(AstResource &resource,
+                                     SubroutineRef *ref,
                                      Expr **posArgs, unsigned numPos,
                                      KeywordSelector **keys, unsigned numKeys)
     : Stmt(AST_ProcedureCallStmt, ref->getLocation()),
-      SubroutineCall(ref, posArgs, numPos, keys, numKeys)
+      SubroutineCall(resource, ref, posArgs, numPos, keys, numKeys)
 {
     assert(ref->isResolved() && "Cannot form unresolved procedure calls!");
 }
 
-//===----------------------------------------------------------------------===//
-// ReturnStmt
-ReturnStmt::~ReturnStmt()
-{
-    if (returnExpr) delete returnExpr;
-}
-
 //===----------------------------------------------------------------------===//
 // AssignmentStmt
 AssignmentStmt::AssignmentStmt(Expr *target, Expr *value)
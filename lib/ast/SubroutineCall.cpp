@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "comma/ast/AstResource.h"
 #include "comma/ast/AttribDecl.h"
 #include "comma/ast/Expr.h"
 #include "comma/ast/KeywordSelector.h"
@@ -18,36 +19,39 @@ using llvm::dyn_cast;
 using llvm::cast;
 using llvm::isa;
 
-SubroutineCall::SubroutineCall(SubroutineRef *connective,
+SubroutineCall::SubroutineCall(AstResource &resource,
+                               SubroutineRef *connective,
                                Expr **posArgs, unsigned numPos,
                                KeywordSelector **keyArgs, unsigned numKeys)
     : connective(connective),
       numPositional(numPos),
       numKeys(numKeys)
 {
-    initializeArguments(posArgs, numPos, keyArgs, numKeys);
+    initializeArguments(resource, posArgs, numPos, keyArgs, numKeys);
 }
 
 // FIXME: It would be nice to have a representation where a resolved call
 // disposes of the reference node and replaces it directly with the declaration.
-SubroutineCall::SubroutineCall(SubroutineDecl *connective,
+SubroutineCall::SubroutineCall(AstResource &resource,
+                               SubroutineDecl *connective,
                                Expr **posArgs, unsigned numPos,
                                KeywordSelector **keyArgs, unsigned numKeys)
-    : connective(new SubroutineRef(Location(), connective)),
+    : connective(new (resource) SubroutineRef(Location(), connective)),
       numPositional(numPos),
       numKeys(numKeys)
 {
-    initializeArguments(posArgs, numPos, keyArgs, numKeys);
+    initializeArguments(resource, posArgs, numPos, keyArgs, numKeys);
 }
 
 void
-SubroutineCall::initializeArguments(Expr **posArgs, unsigned numPos,
+SubroutineCall::initializeArguments(AstResource &resource,
+                                    Expr **posArgs, unsigned numPos,
                                     KeywordSelector **keyArgs, unsigned numKeys)
 {
     unsigned numArgs = numPositional + numKeys;
 
     if (numArgs) {
-        arguments = new Expr*[numArgs];
+        arguments = resource.allocateArray<Expr*>(numArgs);
         std::copy(posArgs, posArgs + numPos, arguments);
         std::fill(arguments + numPos, arguments + numArgs, (Expr*)0);
     }
@@ -55,7 +59,7 @@ SubroutineCall::initializeArguments(Expr **posArgs, unsigned numPos,
         arguments = 0;
 
     if (numKeys) {
-        keyedArgs = new KeywordSelector*[numKeys];
+        keyedArgs = resource.allocateArray<KeywordSelector*>(numKeys);
         std::copy(keyArgs, keyArgs + numKeys, keyedArgs);
     }
     else
@@ -87,14 +91,6 @@ void SubroutineCall::propagateKeyedArguments()
     }
 }
 
-SubroutineCall::~SubroutineCall()
-{
-    // FIXME: Traverse the argument list and free each expression.
-    delete connective;
-    delete[] arguments;
-    delete[] keyedArgs;
-}
-
 bool SubroutineCall::isaFunctionCall() const
 {
     return isa<FunctionCallExpr>(this);
@@ -201,14 +201,15 @@ bool Type::isSubtypeOf(const Type *type) const
 //===----------------------------------------------------------------------===//
 // SubroutineType
 
-SubroutineType::SubroutineType(AstKind kind, Type **argTypes, unsigned numArgs)
+SubroutineType::SubroutineType(AstKind kind, AstResource &resource,
+                               Type **argTypes, unsigned numArgs)
     : Type(kind),
       argumentTypes(0),
       numArguments(numArgs)
 {
     assert(this->denotesSubroutineType());
     if (numArgs > 0) {
-        argumentTypes = new Type*[numArgs];
+        argumentTypes = resource.allocateArray<Type*>(numArgs);
         std::copy(argTypes, argTypes + numArgs, argumentTypes);
     }
 }
@@ -262,10 +263,10 @@ bool SubroutineType::compareProfiles(const SubroutineType *X,
 //===----------------------------------------------------------------------===//
 // UniversalType
 
-UniversalType *UniversalType::universal_integer = 0;
-UniversalType *UniversalType::universal_access  = 0;
-UniversalType *UniversalType::universal_fixed   = 0;
-UniversalType *UniversalType::universal_real    = 0;
+UniversalType UniversalType::universal_integer;
+UniversalType UniversalType::universal_access;
+UniversalType UniversalType::universal_fixed;
+UniversalType UniversalType::universal_real;
 
 //===----------------------------------------------------------------------===//
 // IncompleteType
@@ -586,11 +587,11 @@ private:
 class ConstrainedEnumType : public EnumerationType {
 
 public:
-    ConstrainedEnumType(EnumerationType *base,
+    ConstrainedEnumType(AstResource &resource, EnumerationType *base,
                         Expr *lowerBound, Expr *upperBound,
                         EnumerationDecl *decl = 0)
         : EnumerationType(ConstrainedEnumType_KIND, base),
-          constraint(new Range(lowerBound, upperBound, base)),
+          constraint(new (resource) Range(lowerBound, upperBound, base)),
           definingDecl(decl) { }
 
     /// Returns true if this is an anonymous subtype.
@@ -733,21 +734,24 @@ ValAD *EnumerationType::getValAttribute()
 EnumerationType *EnumerationType::create(AstResource &resource,
                                          EnumerationDecl *decl)
 {
-    return new RootEnumType(resource, decl);
+    return new (resource) RootEnumType(resource, decl);
 }
 
-EnumerationType *EnumerationType::createSubtype(EnumerationType *type,
+EnumerationType *EnumerationType::createSubtype(AstResource &resource,
+                                                EnumerationType *type,
                                                 EnumerationDecl *decl)
 {
-    return new UnconstrainedEnumType(type, decl);
+    return new (resource) UnconstrainedEnumType(type, decl);
 }
 
 EnumerationType *
-EnumerationType::createConstrainedSubtype(EnumerationType *type,
+EnumerationType::createConstrainedSubtype(AstResource &resource,
+                                          EnumerationType *type,
                                           Expr *lowerBound, Expr *upperBound,
                                           EnumerationDecl *decl)
 {
-    return new ConstrainedEnumType(type, lowerBound, upperBound, decl);
+    return new (resource) ConstrainedEnumType(resource, type,
+                                              lowerBound, upperBound, decl);
 }
 
 //===----------------------------------------------------------------------===//
@@ -810,10 +814,10 @@ private:
 class ConstrainedIntegerType : public IntegerType {
 
 public:
-    ConstrainedIntegerType(IntegerType *base, Expr *lower, Expr *upper,
-                           IntegerDecl *decl = 0)
+    ConstrainedIntegerType(AstResource &resource, IntegerType *base,
+                           Expr *lower, Expr *upper, IntegerDecl *decl = 0)
         : IntegerType(ConstrainedIntegerType_KIND, base),
-          constraint(new Range(lower, upper, base)),
+          constraint(new (resource) Range(lower, upper, base)),
           definingDecl(decl) { }
 
     /// Returns true if this is an anonymous subtype.
@@ -942,21 +946,24 @@ IntegerType *IntegerType::create(AstResource &resource, IntegerDecl *decl,
                                  const llvm::APInt &lower,
                                  const llvm::APInt &upper)
 {
-    return new RootIntegerType(resource, decl, lower, upper);
+    return new (resource) RootIntegerType(resource, decl, lower, upper);
 }
 
-IntegerType *IntegerType::createSubtype(IntegerType *type,
+IntegerType *IntegerType::createSubtype(AstResource &resource,
+                                        IntegerType *type,
                                         IntegerDecl *decl)
 {
-    return new UnconstrainedIntegerType(type, decl);
+    return new (resource) UnconstrainedIntegerType(type, decl);
 }
 
-IntegerType *IntegerType::createConstrainedSubtype(IntegerType *type,
+IntegerType *IntegerType::createConstrainedSubtype(AstResource &resource,
+                                                   IntegerType *type,
                                                    Expr *lowerBound,
                                                    Expr *upperBound,
                                                    IntegerDecl *decl)
 {
-    return new ConstrainedIntegerType(type, lowerBound, upperBound, decl);
+    return new (resource) ConstrainedIntegerType(resource, type,
+                                                 lowerBound, upperBound, decl);
 }
 
 IntegerType *IntegerType::getBaseSubtype()
@@ -1052,14 +1059,16 @@ PrivateType::PrivateType(PrivateType *base)
 {
 }
 
-PrivateType *PrivateType::createPrivateType(PrivateTypeDecl *decl)
+PrivateType *PrivateType::createPrivateType(AstResource &resource,
+                                            PrivateTypeDecl *decl)
 {
-    return new PrivateType(decl);
+    return new (resource) PrivateType(decl);
 }
 
-PrivateType *PrivateType::createPrivateSubtype(PrivateType *base)
+PrivateType *PrivateType::createPrivateSubtype(AstResource &resource,
+                                               PrivateType *base)
 {
-    return new PrivateType(base);
+    return new (resource) PrivateType(base);
 }
 
 PrivateTypeDecl *PrivateType::getDefiningDecl()
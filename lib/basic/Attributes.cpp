@@ -9,6 +9,7 @@
 #include "comma/basic/Attributes.h"
 #include "comma/basic/IdentifierPool.h"
 
+#include <cassert>
 #include <cstring>
 
 using namespace comma;
@@ -46,11 +47,34 @@ AttributeID comma::attrib::getAttributeID(const char *start, const char *end)
 {
     size_t len = end - start;
 
-    for (unsigned cursor = FIRST_ATTRIB; cursor <= LAST_ATTRIB; ++cursor) {
-        AttributeID ID = static_cast<AttributeID>(cursor);
-        const char *name = getAttributeString(ID);
-        if (::strlen(name) == len && strncmp(name, start, len) == 0)
-            return ID;
+    if (len == 0)
+        return UNKNOWN_ATTRIBUTE;
+
+    // Attribute names are distinguished by their first character and length.
+    // The following table is indexed by their sum (mod 16) and is populated on
+    // first use.  Lookups are case insensitive.
+    static AttributeID table[16];
+    static bool initialized = false;
+
+    if (!initialized) {
+        for (unsigned cursor = FIRST_ATTRIB; cursor <= LAST_ATTRIB; ++cursor) {
+            AttributeID ID = static_cast<AttributeID>(cursor);
+            const char *name = getAttributeString(ID);
+            AttributeID &entry = table[(name[0] + ::strlen(name)) & 15];
+            assert(entry == UNKNOWN_ATTRIBUTE && "Attribute hash collision!");
+            entry = ID;
+        }
+        initialized = true;
+    }
+
+    AttributeID ID = table[((start[0] | 0x20) + len) & 15];
+    if (ID == UNKNOWN_ATTRIBUTE)
+        return ID;
+
+    const char *name = getAttributeString(ID);
+    for (size_t i = 0; i < len; ++i) {
+        if ((start[i] | 0x20) != name[i])
+            return UNKNOWN_ATTRIBUTE;
     }
-    return UNKNOWN_ATTRIBUTE;
+    return name[len] == 0 ? ID : UNKNOWN_ATTRIBUTE;
 }
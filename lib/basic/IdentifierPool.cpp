@@ -0,0 +1,37 @@
+//===-- basic/IdentifierPool.cpp ------------------------------ -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+#include "comma/basic/IdentifierPool.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cctype>
+
+using namespace comma;
+
+IdentifierInfo &IdentifierPool::getFoldedIdentifierInfo(llvm::StringRef name)
+{
+    llvm::SmallString<64> key;
+    for (llvm::StringRef::iterator I = name.begin(); I != name.end(); ++I)
+        key.push_back(std::tolower(*I));
+    return getIdentifierInfo(key.str());
+}
+
+void IdentifierPool::printStats(llvm::raw_ostream &stream) const
+{
+    // Each entry is allocated together with a null terminated copy of its key.
+    size_t entryBytes = 0;
+    for (iterator I = begin(); I != end(); ++I)
+        entryBytes += sizeof(PoolType::MapEntryTy) + I->getKeyLength() + 1;
+
+    stream << "*** Identifier pool statistics:\n"
+           << "  " << size() << " identifiers\n"
+           << "  " << entryBytes << " bytes in entries\n"
+           << "  " << pool.getNumBuckets() << " hash buckets\n";
+}
@@ -10,37 +10,97 @@
 
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
 #include <cstdlib>
 
 using namespace comma;
 
 TextManager::~TextManager()
 {
-    typedef ProviderMap::iterator iterator;
+    typedef ProviderVector::iterator iterator;
     for (iterator I = providers.begin(); I != providers.end(); ++I)
-        delete I->second;
+        delete *I;
+}
+
+void TextManager::printStats(llvm::raw_ostream &stream) const
+{
+    unsigned numOpen = 0;
+    size_t bufferBytes = 0;
+    size_t lineBytes = 0;
+
+    typedef ProviderVector::const_iterator iterator;
+    for (iterator I = providers.begin(); I != providers.end(); ++I) {
+        TextProvider *provider = *I;
+        if (!provider->isClosed())
+            ++numOpen;
+        bufferBytes += provider->getBufferSize();
+        lineBytes += provider->getLineTableSize();
+    }
+
+    stream << "*** Text statistics:\n"
+           << "  " << providers.size() << " providers ("
+           << numOpen << " open)\n"
+           << "  " << bufferBytes << " bytes in open buffers\n"
+           << "  " << lineBytes << " bytes in line tables\n";
 }
 
 TextProvider &TextManager::create(const llvm::sys::Path& path)
 {
-    if (nextProviderID > Location::MAX_LOCATION_STAMP) {
-        llvm::errs() << "Too many files managed (location stamp overflow).";
+    TextProvider *provider = new TextProvider(nextBase, path);
+
+    // Ensure the provider's range fits within the remaining offsets.
+    if (provider->getExtent() > ~0U - nextBase) {
+        llvm::errs() << "Too much source text managed (location overflow).";
         abort();
     }
 
-    assert(providers.count(nextProviderID) == 0 && "Corrupt TextManager table!");
-
-    TextProvider *provider = new TextProvider(nextProviderID, path);
-    providers[nextProviderID] = provider;
-    nextProviderID++;
+    providers.push_back(provider);
+    paths.push_back(path.str());
+    nextBase += provider->getExtent();
     return *provider;
 }
 
+void TextManager::release(const llvm::sys::Path &path)
+{
+    unsigned index = 0;
+    while (index < providers.size()) {
+        if (paths[index] == path.str()) {
+            delete providers[index];
+            providers.erase(providers.begin() + index);
+            paths.erase(paths.begin() + index);
+        }
+        else
+            ++index;
+    }
+
+    // Reclaim the offsets following the last remaining provider.
+    if (providers.empty())
+        nextBase = 1;
+    else {
+        TextProvider *last = providers.back();
+        nextBase = last->getBaseOffset() + last->getExtent();
+    }
+}
+
+namespace {
+
+/// Orders a Location offset relative to the base of a TextProvider.
+bool precedesProvider(unsigned offset, const TextProvider *provider)
+{
+    return offset < provider->getBaseOffset();
+}
+
+} // end anonymous namespace.
+
 SourceLocation TextManager::getSourceLocation(const Location loc) const
 {
-    unsigned stamp = loc.getStamp();
-    TextProvider *provider = providers.lookup(stamp);
+    // Find the last provider with a base not exceeding the given offset.
+    ProviderVector::const_iterator I;
+    I = std::upper_bound(providers.begin(), providers.end(),
+                         loc.getOffset(), precedesProvider);
 
-    assert(provider && "Location does not map to any TextProvider.");
+    assert(I != providers.begin() &&
+           "Location does not map to any TextProvider.");
+    TextProvider *provider = *--I;
     return provider->getSourceLocation(loc);
 }
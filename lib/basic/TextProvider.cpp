@@ -14,8 +14,8 @@
 
 using namespace comma;
 
-TextProvider::TextProvider(unsigned ID, const llvm::sys::Path &path)
-    : locationStamp(ID)
+TextProvider::TextProvider(unsigned base, const llvm::sys::Path &path)
+    : base(base)
 {
     memBuffer = llvm::MemoryBuffer::getFileOrSTDIN(path.c_str());
 
@@ -31,24 +31,27 @@ TextProvider::TextProvider(unsigned ID, const llvm::sys::Path &path)
     if (identity.compare("-") == 0)
         identity = "<stdin>";
 
+    extent = memBuffer->getBufferSize() + 1;
     initializeLinevec();
 }
 
-TextProvider::TextProvider(unsigned ID, const char *raw, size_t length)
-    : locationStamp(ID)
+TextProvider::TextProvider(unsigned base, const char *raw, size_t length)
+    : base(base)
 {
     memBuffer = llvm::MemoryBuffer::getMemBufferCopy(raw, raw + length);
     buffer = memBuffer->getBufferStart();
+    extent = length + 1;
     initializeLinevec();
 }
 
-TextProvider::TextProvider(unsigned ID, const std::string &str)
-    : locationStamp(ID)
+TextProvider::TextProvider(unsigned base, const std::string &str)
+    : base(base)
 {
     const char *start = str.c_str();
     const char *end   = start + str.size();
     memBuffer = llvm::MemoryBuffer::getMemBufferCopy(start, end);
     buffer = memBuffer->getBufferStart();
+    extent = str.size() + 1;
     initializeLinevec();
 }
 
@@ -66,9 +69,14 @@ void TextProvider::close()
     }
 }
 
+size_t TextProvider::getBufferSize() const
+{
+    return memBuffer ? memBuffer->getBufferSize() : 0;
+}
+
 Location TextProvider::getLocation(const TextIterator &ti) const
 {
-    return Location(locationStamp, indexOf(ti.cursor));
+    return Location(base + indexOf(ti.cursor));
 }
 
 SourceLocation TextProvider::getSourceLocation(const TextIterator &ti) const
@@ -97,27 +105,33 @@ TextIterator TextProvider::end() const
     return TextIterator(memBuffer->getBufferEnd());
 }
 
-std::string TextProvider::extract(Location start, Location end) const
+llvm::StringRef TextProvider::getText(Location start, Location end) const
 {
     assert(!isClosed() && "Cannot extract text form a closed TextProvider!");
 
-    std::string str;
-    unsigned x = start.getOffset();
-    unsigned y = end.getOffset();
+    unsigned x = indexOf(start);
+    unsigned y = indexOf(end);
     assert(x <= y && "Inconsistent Location range!");
     assert(y < indexOf(memBuffer->getBufferEnd()) && "Locations out of range!");
-    str.insert(0, &buffer[x], y - x + 1);
-    return str;
+    return llvm::StringRef(&buffer[x], y - x + 1);
+}
+
+llvm::StringRef TextProvider::getText(const TextIterator &s,
+                                      const TextIterator &e) const
+{
+    assert(!isClosed() && "Cannot extract text form a closed TextProvider!");
+    return llvm::StringRef(s.cursor, e.cursor - s.cursor);
+}
+
+std::string TextProvider::extract(Location start, Location end) const
+{
+    return getText(start, end).str();
 }
 
 std::string TextProvider::extract(const TextIterator &s,
                                   const TextIterator &e) const
 {
-    assert(!isClosed() && "Cannot extract text form a closed TextProvider!");
-    std::string str;
-    unsigned length = e.cursor - s.cursor;
-    str.insert(0, s.cursor, length);
-    return str;
+    return getText(s, e).str();
 }
 
 std::string TextProvider::extract(const SourceLocation &sloc) const
@@ -212,13 +226,12 @@ void TextProvider::finishLinevec()
 
 unsigned TextProvider::getLine(Location loc) const
 {
-    assert(loc.getStamp() == getNumericIdentity() &&
-           "Location not associated with this TextProvider!");
+    unsigned index = indexOf(loc);
 
     // If the location is greater than the current range of the line vector
     // extend the line vector.
-    if (loc >= maxLineIndex)
-        return extendLinevec(loc);
+    if (index >= maxLineIndex)
+        return extendLinevec(index);
 
     // Otherwise, perform a binary search over the existing line vector.
     int max = lines.size();
@@ -227,9 +240,9 @@ unsigned TextProvider::getLine(Location loc) const
     while (start <= end) {
         int mid = (start + end) >> 1;
         unsigned candidate = lines[mid];
-        if (candidate <= loc) {
+        if (candidate <= index) {
             if (mid + 1 < max) {
-                if (lines[mid + 1] <= loc) {
+                if (lines[mid + 1] <= index) {
                     start = ++mid;
                     continue;
                 }
@@ -246,7 +259,7 @@ unsigned TextProvider::getLine(Location loc) const
 unsigned TextProvider::getColumn(Location loc) const
 {
     unsigned start = lines[getLine(loc) - 1];
-    return loc - start;
+    return indexOf(loc) - start;
 }
 
 std::pair<unsigned, unsigned> TextProvider::getLineOf(Location loc) const
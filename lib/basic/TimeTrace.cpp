@@ -0,0 +1,117 @@
+//===-- basic/TimeTrace.cpp ----------------------------------- -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+#include "comma/basic/TimeTrace.h"
+
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/System/TimeValue.h"
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+using namespace comma;
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    std::string detail;
+    uint64_t start;
+    uint64_t duration;
+};
+
+std::vector<TraceEvent> events;
+std::vector<unsigned> openEvents;
+uint64_t origin;
+
+/// Returns the current time in microseconds.
+uint64_t now()
+{
+    llvm::sys::TimeValue time = llvm::sys::TimeValue::now();
+    return uint64_t(time.seconds()) * 1000000 + time.microseconds();
+}
+
+/// Writes the given string as a JSON string literal.
+void writeString(llvm::raw_ostream &stream, llvm::StringRef str)
+{
+    stream << '"';
+    for (llvm::StringRef::iterator I = str.begin(); I != str.end(); ++I) {
+        char c = *I;
+        if (c == '"' || c == '\\')
+            stream << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            char buff[8];
+            std::sprintf(buff, "\\u%04x", c);
+            stream << buff;
+        }
+        else
+            stream << c;
+    }
+    stream << '"';
+}
+
+} // end anonymous namespace.
+
+bool TimeTrace::enabled = false;
+
+void TimeTrace::enable()
+{
+    events.clear();
+    openEvents.clear();
+    origin = now();
+    enabled = true;
+}
+
+void TimeTrace::begin(const char *name, llvm::StringRef detail)
+{
+    TraceEvent event;
+    event.name = name;
+    event.detail = detail.str();
+    event.start = now() - origin;
+    event.duration = 0;
+    openEvents.push_back(events.size());
+    events.push_back(event);
+}
+
+void TimeTrace::end()
+{
+    assert(!openEvents.empty() && "Unbalanced trace events!");
+    TraceEvent &event = events[openEvents.back()];
+    event.duration = now() - origin - event.start;
+    openEvents.pop_back();
+}
+
+bool TimeTrace::write(const std::string &path)
+{
+    std::string message;
+    llvm::raw_fd_ostream output(path.c_str(), message, 0);
+    if (!message.empty()) {
+        llvm::errs() << "Could not write time trace: " << message << '\n';
+        return false;
+    }
+
+    output << "{\"traceEvents\":[";
+    typedef std::vector<TraceEvent>::const_iterator iterator;
+    for (iterator I = events.begin(); I != events.end(); ++I) {
+        if (I != events.begin())
+            output << ',';
+        output << "\n{\"pid\":1,\"tid\":0,\"ph\":\"X\",\"ts\":" << I->start
+               << ",\"dur\":" << I->duration << ",\"name\":";
+        writeString(output, I->name);
+        if (!I->detail.empty()) {
+            output << ",\"args\":{\"detail\":";
+            writeString(output, I->detail);
+            output << '}';
+        }
+        output << '}';
+    }
+    output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return true;
+}
@@ -16,8 +16,14 @@
 #include "comma/ast/Cunit.h"
 #include "comma/ast/Decl.h"
 #include "comma/basic/TextManager.h"
+#include "comma/basic/TimeTrace.h"
 #include "comma/codegen/Mangle.h"
 
+#include "llvm/PassManager.h"
+#include "llvm/Support/StandardPasses.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO.h"
+
 using namespace comma;
 
 using llvm::dyn_cast;
@@ -32,11 +38,56 @@ CodeGen::CodeGen(llvm::Module *M, const llvm::TargetData &data,
       Resource(resource),
       CRT(new CommaRT(*this)),
       CGT(new CodeGenTypes(*this)),
-      moduleName(0) { }
+      moduleName(0),
+      FPM(0),
+      MPM(0) { }
 
 CodeGen::~CodeGen()
 {
     delete CRT;
+    delete FPM;
+    delete MPM;
+}
+
+void CodeGen::setOptimizationLevel(unsigned level, bool optimizeSize)
+{
+    delete FPM;
+    delete MPM;
+    FPM = 0;
+    MPM = 0;
+
+    if (level == 0)
+        return;
+
+    FPM = new llvm::FunctionPassManager(M);
+    FPM->add(new llvm::TargetData(TD));
+    llvm::createStandardFunctionPasses(FPM, level);
+    FPM->doInitialization();
+
+    // Only subroutines explicitly marked for inlining are inlined at level
+    // one.
+    llvm::Pass *inliner;
+    if (level == 1)
+        inliner = llvm::createAlwaysInlinerPass();
+    else if (optimizeSize)
+        inliner = llvm::createFunctionInliningPass(50);
+    else
+        inliner = llvm::createFunctionInliningPass(level > 2 ? 250 : 200);
+
+    MPM = new llvm::PassManager();
+    MPM->add(new llvm::TargetData(TD));
+    llvm::createStandardModulePasses(MPM, level, optimizeSize,
+                                     true,      // Unit at a time.
+                                     level > 2, // Unroll loops.
+                                     true,      // Simplify library calls.
+                                     true,      // Have exceptions.
+                                     inliner);
+}
+
+void CodeGen::optimizeFunction(llvm::Function *fn)
+{
+    if (FPM)
+        FPM->run(*fn);
 }
 
 void CodeGen::emitCompilationUnit(CompilationUnit *cunit)
@@ -57,6 +108,12 @@ void CodeGen::emitCompilationUnit(CompilationUnit *cunit)
              E = cunit->end_declarations(); I != E; ++I) {
         emitToplevelDecl(*I);
     }
+
+    if (MPM) {
+        TimeTraceScope trace("Optimize module", M->getModuleIdentifier());
+        FPM->doFinalization();
+        MPM->run(*M);
+    }
 }
 
 void CodeGen::emitToplevelDecl(Decl *decl)
@@ -78,6 +135,8 @@ void CodeGen::emitToplevelDecl(Decl *decl)
 
 void CodeGen::emitPackage(InstanceInfo *info)
 {
+    TimeTraceScope trace("CodeGen package", info->getLinkName());
+
     // Codegen each subroutine.
     IInfo = info;
     PkgInstanceDecl *instance = IInfo->getInstance();
@@ -98,6 +157,40 @@ void CodeGen::emitPackage(InstanceInfo *info)
     IInfo = 0;
 }
 
+void CodeGen::printStats(llvm::raw_ostream &stream) const
+{
+    stream << "*** CodeGen statistics for `" << M->getModuleIdentifier()
+           << "':\n"
+           << "  " << CGT->getNumLoweredTypes() << " lowered types\n"
+           << "  " << InstanceTable.size() << " instances\n";
+
+    typedef InstanceMap::const_iterator iterator;
+    for (iterator I = InstanceTable.begin(); I != InstanceTable.end(); ++I) {
+        const InstanceInfo *info = I->second;
+        if (!info->isCompiled())
+            continue;
+
+        // Count the instructions of each subroutine defined by the instance.
+        unsigned numFunctions = 0;
+        unsigned numInsts = 0;
+        typedef InstanceInfo::SRInfoMap::const_iterator sr_iterator;
+        for (sr_iterator S = info->srInfoTable.begin();
+             S != info->srInfoTable.end(); ++S) {
+            const llvm::Function *fn = S->second->getLLVMFunction();
+            if (fn->isDeclaration())
+                continue;
+            ++numFunctions;
+            typedef llvm::Function::const_iterator bb_iterator;
+            for (bb_iterator B = fn->begin(); B != fn->end(); ++B)
+                numInsts += B->size();
+        }
+
+        if (numFunctions)
+            stream << "  " << info->getLinkName() << ": " << numFunctions
+                   << " functions, " << numInsts << " instructions\n";
+    }
+}
+
 void CodeGen::emitEntry(ProcedureDecl *pdecl)
 {
     // Basic sanity checks on the declaration.
@@ -19,6 +19,11 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 
+namespace llvm {
+class FunctionPassManager;
+class PassManager;
+} // end llvm namespace.
+
 namespace comma {
 
 class CodeGenTypes;
@@ -60,6 +65,10 @@ public:
     InstanceInfo *getInstanceInfo() { return IInfo; }
     //@}
 
+    /// Applies the per-function optimization pipeline to the given function.
+    /// This is a no-op if optimizations are disabled.
+    void optimizeFunction(llvm::Function *fn);
+
     /// Returns the LLVMContext associated with this code generator.
     llvm::LLVMContext &getLLVMContext() const {
         return getModule()->getContext();
@@ -76,8 +85,9 @@ public:
     /// place.  First, the instance is schedualed for codegen, meaning that
     /// specializations of that instances subroutines will be emmited into the
     /// current module.  Second, forward declarations are created for each of
-    /// the instances subroutines.  These declarations are accessible thru the
-    /// lookupGlobal method using the appropriately mangled name.
+    /// the instances subroutines as they are referenced thru getSRInfo.  These
+    /// declarations are accessible thru the lookupGlobal method using the
+    /// appropriately mangled name.
     bool extendWorklist(PkgInstanceDecl *instance);
 
     InstanceInfo *lookupInstanceInfo(const PkgInstanceDecl *instance) const {
@@ -92,8 +102,8 @@ public:
 
     /// \brief Returns the SRInfo object associated with \p srDecl.
     ///
-    /// The given instance must be registered with the code generator.  If the
-    /// lookup of \p srDecl fails an assertion will fire.
+    /// The given instance must be registered with the code generator.  The
+    /// SRInfo object is created on the first request for \p srDecl.
     SRInfo *getSRInfo(PkgInstanceDecl *instance, SubroutineDecl *srDecl);
 
     /// \brief Adds a mapping between the given link name and an LLVM
@@ -370,6 +380,12 @@ private:
     /// method.
     llvm::Constant *moduleName;
 
+    /// Optimization pipelines run over each generated function and over the
+    /// complete module, respectively.  Both are null when optimizations are
+    /// disabled.
+    llvm::FunctionPassManager *FPM;
+    llvm::PassManager *MPM;
+
     /// Generates an InstanceInfo object and adds it to the instance table.
     ///
     /// This method will assert if there already exists an info object for the
@@ -399,6 +415,8 @@ private:
     void emitCompilationUnit(CompilationUnit *cunit);
     void emitToplevelDecl(Decl *decl);
     void emitEntry(ProcedureDecl *decl);
+    void setOptimizationLevel(unsigned level, bool optimizeSize);
+    void printStats(llvm::raw_ostream &stream) const;
 };
 
 } // end comma namespace.
@@ -20,8 +20,6 @@
 #include "comma/ast/AggExpr.h"
 #include "comma/ast/Type.h"
 
-#include <algorithm>
-
 using namespace comma;
 
 using llvm::dyn_cast;
@@ -30,6 +28,13 @@ using llvm::isa;
 
 namespace {
 
+/// Returns the given limit of an index type in the representation used by
+/// KeyIntervalSet.
+uint64_t getLimitValue(const llvm::APInt &limit, bool isSigned)
+{
+    return isSigned ? limit.getSExtValue() : limit.getZExtValue();
+}
+
 //===----------------------------------------------------------------------===//
 /// \class
 ///
@@ -832,45 +837,40 @@ void ArrayEmitter::fillInOthers(AggregateExpr *agg, llvm::Value *dst,
 
     DiscreteType *idxTy = cast<ArrayType>(agg->getType())->getIndexType(0);
     const llvm::Type *iterTy = lower->getType();
+    bool isSigned = idxTy->isSigned();
 
-    // Build a sorted vector of the keys supplied by the aggregate.
-    typedef std::vector<ComponentKey*> KeyVec;
-    KeyVec KV(agg->key_begin(), agg->key_end());
-    if (idxTy->isSigned())
-        std::sort(KV.begin(), KV.end(), ComponentKey::compareKeysS);
-    else
-        std::sort(KV.begin(), KV.end(), ComponentKey::compareKeysU);
+    // Collapse the keys supplied by the aggregate into contiguous runs.  The
+    // holes to be filled lie between consecutive runs.
+    KeyIntervalSet keySet(agg->key_begin(), agg->key_end(), isSigned);
+    unsigned numRuns = keySet.numRuns();
 
     llvm::APInt limit;
-    llvm::APInt lowerValue;
-    llvm::APInt upperValue;
+    uint64_t lowerValue;
+    uint64_t upperValue;
 
     // Fill in any missing leading elements.
-    KV.front()->getLowerValue(lowerValue);
+    lowerValue = keySet.getRunLower(0);
     idxTy->getLowerLimit(limit);
-    if (lowerValue != limit) {
+    if (lowerValue != getLimitValue(limit, isSigned)) {
         llvm::Value *end = llvm::ConstantInt::get(iterTy, lowerValue);
         emitOthers(others, dst, lower, end, lower);
     }
 
     // Fill in each interior "hole".
-    for (unsigned i = 0; i < KV.size() - 1; ++i) {
+    for (unsigned i = 0; i < numRuns - 1; ++i) {
         // Note the change in the sense of "upper" and "lower" here.
-        KV[i]->getUpperValue(lowerValue);
-        KV[i+1]->getLowerValue(upperValue);
-
-        if (lowerValue == upperValue)
-            continue;
+        lowerValue = keySet.getRunUpper(i);
+        upperValue = keySet.getRunLower(i + 1);
 
-        llvm::Value *start = llvm::ConstantInt::get(iterTy, ++lowerValue);
+        llvm::Value *start = llvm::ConstantInt::get(iterTy, lowerValue + 1);
         llvm::Value *end = llvm::ConstantInt::get(iterTy, upperValue);
         emitOthers(others, dst, start, end, lower);
     }
 
     // Fill in any missing trailing elements.
-    KV.back()->getUpperValue(upperValue);
+    upperValue = keySet.getRunUpper(numRuns - 1);
     idxTy->getUpperLimit(limit);
-    if (upperValue != limit) {
+    if (upperValue != getLimitValue(limit, isSigned)) {
         llvm::Value *start;
         llvm::Value *end;
         start = llvm::ConstantInt::get(iterTy, upperValue);
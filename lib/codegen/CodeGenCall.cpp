@@ -766,8 +766,8 @@ SRInfo *CallEmitter::prepareDirectCall()
     PkgInstanceDecl *instance = cast<PkgInstanceDecl>(srDecl->getDeclRegion());
 
     // Add the target instance to the code generators worklist.  This will
-    // generate SRInfo objects for this particular instance if they do not
-    // already exist and schedual the associated functions for generation.
+    // schedual the associated functions for generation if they are not
+    // already pending.
     CG.extendWorklist(instance);
 
     // Lookup the corresponding SRInfo object.
@@ -266,7 +266,8 @@ CValue CodeGenRoutine::emitConversionValue(ConversionExpr *expr)
     Type *targetTy = expr->getType();
 
     if (DiscreteType *target = dyn_cast<DiscreteType>(targetTy))
-        return emitDiscreteConversion(expr->getOperand(), target);
+        return emitDiscreteConversion(expr->getOperand(), target,
+                                      expr->isStaticallyInRange());
 
     if (AccessType *target = dyn_cast<AccessType>(targetTy))
         return emitAccessConversion(expr->getOperand(), target);
@@ -440,7 +441,8 @@ void CodeGenRoutine::emitNullAccessCheck(llvm::Value *pointer, Location loc)
 }
 
 CValue CodeGenRoutine::emitDiscreteConversion(Expr *expr,
-                                              DiscreteType *targetTy)
+                                              DiscreteType *targetTy,
+                                              bool inRange)
 {
     // Evaluate the source expression.
     Type *exprTy = expr->getType();
@@ -514,7 +516,10 @@ CValue CodeGenRoutine::emitDiscreteConversion(Expr *expr,
                "Unexpected expression type!");
     }
 
-    emitDiscreteRangeCheck(sourceVal, expr->getLocation(), exprTy, targetTy);
+    // Omit the check when the source is known to be in range.
+    if (!inRange)
+        emitDiscreteRangeCheck(sourceVal, expr->getLocation(),
+                               exprTy, targetTy);
 
     // Truncate/extend the value if needed to the target size.
     if (targetWidth < sourceWidth)
@@ -17,6 +17,7 @@
 #include "comma/ast/Pragma.h"
 #include "comma/ast/RangeAttrib.h"
 #include "comma/ast/Stmt.h"
+#include "comma/basic/TimeTrace.h"
 #include "comma/codegen/Mangle.h"
 
 #include "llvm/Analysis/Verifier.h"
@@ -43,11 +44,17 @@ void CodeGenRoutine::emit()
     if (SRI->isImported())
         return;
 
+    TimeTraceScope trace("CodeGen subroutine",
+                         SRI->getLLVMFunction()->getName());
+
     // We need to codegen this subroutine.  Obtain a frame.
     std::auto_ptr<Frame> SRFHandle(new Frame(SRI, *this, Builder));
     SRF = SRFHandle.get();
     emitSubroutineBody();
     llvm::verifyFunction(*SRI->getLLVMFunction());
+
+    // Clean up the function while its code is still fresh in the cache.
+    CG.optimizeFunction(SRI->getLLVMFunction());
 }
 
 void CodeGenRoutine::emitSubroutineBody()
@@ -152,8 +152,11 @@ private:
     llvm::Value *emitArrayBoundAE(ArrayBoundAE *expr);
     llvm::Value *emitLengthAE(LengthAE *expr);
 
-    // Conversion emitters.
-    CValue emitDiscreteConversion(Expr *expr, DiscreteType *target);
+    // Conversion emitters.  When \p inRange is true the value of \p expr is
+    // known to satisfy the constraints of \p target and the range check is
+    // omitted.
+    CValue emitDiscreteConversion(Expr *expr, DiscreteType *target,
+                                  bool inRange);
     CValue emitAccessConversion(Expr *expr, AccessType *target);
 
     /// Emits a range check over discrete types.
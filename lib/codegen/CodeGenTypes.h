@@ -93,6 +93,9 @@ public:
     CallConvention getConvention(const SubroutineDecl *decl);
     //@}
 
+    /// Returns the number of entries in the lowered type map.
+    unsigned getNumLoweredTypes() const { return loweredTypes.size(); }
+
 private:
     CodeGen &CG;
 
@@ -40,71 +40,21 @@ SubroutineDecl *InstanceInfo::getKeySRDecl(SubroutineDecl *srDecl)
 }
 
 InstanceInfo::InstanceInfo(CodeGen &CG, PkgInstanceDecl *instance)
-        : instance(instance),
+        : CG(CG),
+          instance(instance),
           linkName(mangle::getLinkName(instance)),
-          compiledFlag(false)
-{
-    // Populate the info table with all declarations provided by the instance.
-    populateInfoTable(CG, CG.getCGT(), instance);
-}
+          compiledFlag(false) { }
 
-void InstanceInfo::populateInfoTable(CodeGen &CG, CodeGenTypes &CGT,
-                                     PkgInstanceDecl *instance)
+SRInfo *InstanceInfo::getSRInfo(SubroutineDecl *srDecl)
 {
-    DeclRegion::DeclIter I;
-    DeclRegion::DeclIter E;
-
-    // Construct an SRInfo node for each public declaration provided by the
-    // region.
-    E = instance->endDecls();
-    for (I = instance->beginDecls(); I != E; ++I) {
-        /// FIXME: Support all declaration kinds.
-        if (SubroutineDecl *srDecl = dyn_cast<SubroutineDecl>(*I)) {
-            SubroutineDecl *key = getKeySRDecl(srDecl);
-            assert(!srInfoTable.count(key) &&
-                   "Multiple declarations map to the same key!");
-
-            llvm::Function *fn = CG.makeFunction(instance, srDecl, CGT);
-            srInfoTable[key] = new SRInfo(key, fn);
-        }
-    }
-
-    // Similarly for each private declaration.
-    if (PrivatePart *ppart = instance->getDefinition()->getPrivatePart()) {
-        E = ppart->endDecls();
-        for (I = ppart->beginDecls(); I != E; ++I) {
-            /// FIXME: Support all declaration kinds.
-            if (SubroutineDecl *srDecl = dyn_cast<SubroutineDecl>(*I)) {
-                SubroutineDecl *key = getKeySRDecl(srDecl);
-
-                // If an info structure already exists for this declaration skip
-                // it.
-                if(srInfoTable.count(key))
-                    continue;
-
-                llvm::Function *fn = CG.makeFunction(instance, srDecl, CGT);
-                srInfoTable[key] = new SRInfo(key, fn);
-            }
-        }
-    }
-
-    // Similarly for all declarations contained in the body (if it exists).
-    if (BodyDecl *impl = instance->getDefinition()->getImplementation()) {
-        E = impl->endDecls();
-        for (I = impl->beginDecls(); I != E; ++I) {
-            /// FIXME: Support all declaration kinds.
-            if (SubroutineDecl *srDecl = dyn_cast<SubroutineDecl>(*I)) {
-                SubroutineDecl *key = getKeySRDecl(srDecl);
-
-                // If an info structure already exists for this declaration skip
-                // it.
-                if(srInfoTable.count(key))
-                    continue;
-
-                llvm::Function *fn = CG.makeFunction(instance, srDecl, CGT);
-                srInfoTable[key] = new SRInfo(key, fn);
-            }
-        }
-    }
+    SubroutineDecl *key = getKeySRDecl(srDecl);
+    if (SRInfo *info = srInfoTable.lookup(key))
+        return info;
+
+    // Every view of a subroutine lowers to the same function, so the given
+    // declaration can be used to build it.
+    llvm::Function *fn = CG.makeFunction(instance, srDecl, CG.getCGT());
+    SRInfo *info = new SRInfo(key, fn);
+    srInfoTable[key] = info;
+    return info;
 }
-
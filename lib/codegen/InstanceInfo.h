@@ -22,6 +22,7 @@
 
 namespace comma {
 
+class CodeGen;
 class SRInfo;
 
 class InstanceInfo {
@@ -45,18 +46,17 @@ public:
     llvm::StringRef getLinkName() const { return linkName; }
 
     /// Retrieves the SRInfo associated with the given subroutine declaration
-    /// (via a previous call to addSRInfo).  Returns the object if it exists
+    /// (via a previous call to getSRInfo).  Returns the object if it exists
     /// else null.
     SRInfo *lookupSRInfo(SubroutineDecl *srDecl) {
         return srInfoTable.lookup(getKeySRDecl(srDecl));
     }
 
-    /// Like lookupSRInfo, but asserts if the lookup failed.
-    SRInfo *getSRInfo(SubroutineDecl *srDecl) {
-        SRInfo *info = lookupSRInfo(srDecl);
-        assert(info && "SRInfo lookup failed!");
-        return info;
-    }
+    /// Returns the SRInfo associated with the given subroutine declaration.
+    /// SRInfo objects (and the corresponding LLVM function declarations) are
+    /// created on first reference, so only the subroutines actually used by
+    /// the compilation are declared.
+    SRInfo *getSRInfo(SubroutineDecl *srDecl);
 
     /// Marks this instance has having been compiled.
     void markAsCompiled() { compiledFlag = true; }
@@ -70,6 +70,9 @@ private:
 
     friend class CodeGen;
 
+    /// The code generator which owns this info.
+    CodeGen &CG;
+
     /// The instance declaration associated with this info.
     PkgInstanceDecl *instance;
 
@@ -86,11 +89,6 @@ private:
     /// canonical declaration accessable from all views to be used as a key in
     /// the srInfoTable.
     static SubroutineDecl *getKeySRDecl(SubroutineDecl *srDecl);
-
-    /// Populates the srInfoTable with the declarations provided by the
-    /// given instance.
-    void populateInfoTable(CodeGen &CG, CodeGenTypes &CGT,
-                           PkgInstanceDecl *instance);
 };
 
 } // end comma namespace.
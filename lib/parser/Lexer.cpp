@@ -8,14 +8,24 @@
 
 #include "comma/parser/Lexer.h"
 
+#include "llvm/Support/DataTypes.h"
+
+#include <cassert>
 #include <cstring>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace comma;
 
 Lexer::Lexer(TextProvider &txtProvider, Diagnostic &diag)
     : txtProvider(txtProvider),
       diagnostic(diag),
       currentIter(txtProvider.begin()),
+      bufferEnd(&txtProvider.end()),
       errorCount(0),
       scanningAborted(false),
       index(0)
@@ -89,6 +99,179 @@ bool Lexer::isWhitespace(unsigned c)
     return (c == ' ') || (c == '\t') || (c == '\n');
 }
 
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Block scanning.
+//
+// The following routines skip runs of characters belonging to a particular
+// class.  Each takes a pointer into a character buffer and a pointer to the
+// end of the buffer, returning a pointer to the first character not in the
+// class (or the end of the buffer).  When SIMD instructions are available the
+// buffer is examined in 32 (AVX2) or 16 (SSE2) byte blocks, falling back to a
+// scalar loop for the final partial block.  Blocks never extend past the end
+// of the buffer.
+
+#if defined(__AVX2__)
+
+typedef __m256i Block;
+enum { BLOCK_SIZE = 32 };
+
+inline Block loadBlock(const char *ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+inline Block splat(char c) { return _mm256_set1_epi8(c); }
+inline Block blockOr(Block x, Block y) { return _mm256_or_si256(x, y); }
+inline Block blockAnd(Block x, Block y) { return _mm256_and_si256(x, y); }
+inline Block blockEq(Block x, Block y) { return _mm256_cmpeq_epi8(x, y); }
+inline Block blockGt(Block x, Block y) { return _mm256_cmpgt_epi8(x, y); }
+inline uint32_t blockMask(Block x) { return _mm256_movemask_epi8(x); }
+inline void storeBlock(char *ptr, Block x) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), x);
+}
+
+#elif defined(__SSE2__)
+
+typedef __m128i Block;
+enum { BLOCK_SIZE = 16 };
+
+inline Block loadBlock(const char *ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+inline Block splat(char c) { return _mm_set1_epi8(c); }
+inline Block blockOr(Block x, Block y) { return _mm_or_si128(x, y); }
+inline Block blockAnd(Block x, Block y) { return _mm_and_si128(x, y); }
+inline Block blockEq(Block x, Block y) { return _mm_cmpeq_epi8(x, y); }
+inline Block blockGt(Block x, Block y) { return _mm_cmpgt_epi8(x, y); }
+inline uint32_t blockMask(Block x) { return _mm_movemask_epi8(x); }
+inline void storeBlock(char *ptr, Block x) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), x);
+}
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#define COMMA_LEXER_BLOCK_SCAN
+
+/// Returns a block with each byte set when the corresponding byte of \p x
+/// lies within the range [lo, hi].  Both bounds must be ASCII characters.
+/// Bytes with the high bit set compare as negative and are never in range.
+inline Block blockInRange(Block x, char lo, char hi) {
+    return blockAnd(blockGt(x, splat(lo - 1)), blockGt(splat(hi + 1), x));
+}
+
+/// Returns the mask of bytes in the given block which are whitespace.
+inline uint32_t whitespaceMask(Block x) {
+    Block space = blockOr(blockEq(x, splat(' ')), blockEq(x, splat('\t')));
+    Block eol = blockOr(blockEq(x, splat('\n')), blockEq(x, splat('\r')));
+    return blockMask(blockOr(space, eol));
+}
+
+/// Returns the mask of bytes in the given block which terminate a line.
+inline uint32_t lineEndMask(Block x) {
+    Block eol = blockOr(blockEq(x, splat('\n')), blockEq(x, splat('\r')));
+    return blockMask(blockOr(eol, blockEq(x, splat(0))));
+}
+
+/// Returns the mask of bytes in the given block which may continue an
+/// identifier, excluding underscores.
+inline uint32_t nameMask(Block x) {
+    Block alpha = blockInRange(blockOr(x, splat(0x20)), 'a', 'z');
+    Block digit = blockInRange(x, '0', '9');
+    Block other = blockOr(blockEq(x, splat('%')), blockEq(x, splat('?')));
+    return blockMask(blockOr(blockOr(alpha, digit), other));
+}
+
+/// Returns the index of the lowest set bit of a nonzero mask.
+inline unsigned lowestBit(uint32_t mask) {
+    return __builtin_ctz(mask);
+}
+
+const uint32_t FULL_MASK = uint32_t(~0ULL >> (64 - BLOCK_SIZE));
+
+#endif
+
+inline bool isNameChar(unsigned char c) {
+    return (('a' <= (c | 0x20) && (c | 0x20) <= 'z') ||
+            ('0' <= c && c <= '9') || c == '%' || c == '?');
+}
+
+/// Skips spaces, tabs, and line terminators.
+const char *skipWhitespace(const char *ptr, const char *end)
+{
+#ifdef COMMA_LEXER_BLOCK_SCAN
+    while (end - ptr >= BLOCK_SIZE) {
+        uint32_t mask = whitespaceMask(loadBlock(ptr)) ^ FULL_MASK;
+        if (mask)
+            return ptr + lowestBit(mask);
+        ptr += BLOCK_SIZE;
+    }
+#endif
+    for ( ; ptr != end; ++ptr) {
+        char c = *ptr;
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+            break;
+    }
+    return ptr;
+}
+
+/// Skips to the first line terminator or null character.
+const char *skipToLineEnd(const char *ptr, const char *end)
+{
+#ifdef COMMA_LEXER_BLOCK_SCAN
+    while (end - ptr >= BLOCK_SIZE) {
+        uint32_t mask = lineEndMask(loadBlock(ptr));
+        if (mask)
+            return ptr + lowestBit(mask);
+        ptr += BLOCK_SIZE;
+    }
+#endif
+    for ( ; ptr != end; ++ptr) {
+        char c = *ptr;
+        if (c == '\n' || c == '\r' || c == 0)
+            break;
+    }
+    return ptr;
+}
+
+/// Skips characters which may continue an identifier, with the exception of
+/// underscores (which are subject to additional checks).
+const char *skipNameChars(const char *ptr, const char *end)
+{
+#ifdef COMMA_LEXER_BLOCK_SCAN
+    while (end - ptr >= BLOCK_SIZE) {
+        uint32_t mask = nameMask(loadBlock(ptr)) ^ FULL_MASK;
+        if (mask)
+            return ptr + lowestBit(mask);
+        ptr += BLOCK_SIZE;
+    }
+#endif
+    while (ptr != end && isNameChar(*ptr))
+        ++ptr;
+    return ptr;
+}
+
+/// Copies the characters [ptr, end) into the buffer \p dest, folding upper
+/// case letters to lower case.
+void foldCase(const char *ptr, const char *end, char *dest)
+{
+#ifdef COMMA_LEXER_BLOCK_SCAN
+    while (end - ptr >= BLOCK_SIZE) {
+        Block x = loadBlock(ptr);
+        Block upper = blockInRange(x, 'A', 'Z');
+        storeBlock(dest, blockOr(x, blockAnd(upper, splat(0x20))));
+        ptr += BLOCK_SIZE;
+        dest += BLOCK_SIZE;
+    }
+#endif
+    for ( ; ptr != end; ++ptr, ++dest) {
+        char c = *ptr;
+        *dest = ('A' <= c && c <= 'Z') ? c | 0x20 : c;
+    }
+}
+
+} // end anonymous namespace.
+
 Location Lexer::currentLocation() const
 {
     return txtProvider.getLocation(currentIter);
@@ -142,13 +325,12 @@ bool Lexer::eatComment()
     if (c == '-') {
         ignoreStream();
         if (peekStream() == '-') {
-            // Loop until either a newline or the input stream is
-            // exhausted.
-            for (;;) {
-                c = readStream();
-                if (c == '\n' || c == 0)
-                    return true;
-            }
+            // Skip to either a newline or the end of the input stream, and
+            // consume the terminating character.
+            const char *ptr = &currentIter;
+            currentIter += skipToLineEnd(ptr, bufferEnd) - ptr;
+            readStream();
+            return true;
         }
         else {
             ungetStream();
@@ -163,9 +345,8 @@ bool Lexer::eatWhitespace()
     unsigned c = peekStream();
 
     if (isWhitespace(c)) {
-        do {
-            ignoreStream();
-        } while (isWhitespace(c = peekStream()));
+        const char *ptr = &currentIter;
+        currentIter += skipWhitespace(ptr, bufferEnd) - ptr;
         return true;
     }
     return false;
@@ -200,14 +381,29 @@ void Lexer::emitRealToken(const TextIterator &start, const TextIterator &end)
     emitToken(TKN_REAL, start, end);
 }
 
-void Lexer::emitIdentifierToken(Location loc)
+void Lexer::emitNameToken(Code code, Location loc, const TextIterator &start)
+{
+    llvm::StringRef spelling(&start, &currentIter - &start);
+    llvm::StringRef key = nameBuff.str();
+
+    if (spelling == key)
+        key = spelling;
+    else {
+        char *copy = nameStorage.Allocate<char>(key.size());
+        std::memcpy(copy, key.data(), key.size());
+        key = llvm::StringRef(copy, key.size());
+    }
+    *targetToken = Token(code, loc, spelling, key);
+}
+
+void Lexer::emitIdentifierToken(Location loc, const TextIterator &start)
 {
-    *targetToken = Token(TKN_IDENTIFIER, loc, nameBuff.str());
+    emitNameToken(TKN_IDENTIFIER, loc, start);
 }
 
-void Lexer::emitAttributeToken(Location loc)
+void Lexer::emitAttributeToken(Location loc, const TextIterator &start)
 {
-    *targetToken = Token(TKN_ATTRIBUTE, loc, nameBuff.str());
+    emitNameToken(TKN_ATTRIBUTE, loc, start);
 }
 
 void Lexer::emitCharacterToken(const TextIterator &start, const TextIterator &end)
@@ -215,141 +411,105 @@ void Lexer::emitCharacterToken(const TextIterator &start, const TextIterator &en
     emitToken(TKN_CHARACTER, start, end);
 }
 
-Lexer::Code Lexer::getTokenCode() const
+namespace {
+
+/// \class
+/// \brief Perfect hash table over the reserved words of Tokens.def.
+///
+/// A reserved word is hashed on its first two and last two characters, folded
+/// to lower case.  The multiplier was chosen so that each reserved word maps to
+/// a distinct slot, so a name is classified with a single hash and compare.
+/// Should an addition to Tokens.def introduce a collision the table
+/// constructor fires an assertion, and a new multiplier must be selected.
+class ReservedWordTable {
+
+public:
+    ReservedWordTable();
+
+    /// Returns the code of the reserved word spelled by the given string
+    /// (ignoring case), or Lexer::UNUSED_ID if there is no such word.
+    Lexer::Code lookup(const char *str, unsigned length) const;
+
+private:
+    enum {
+        TABLE_BITS = 7,
+        TABLE_SIZE = 1 << TABLE_BITS
+    };
+
+    struct Entry {
+        const char *string;
+        unsigned length;
+        Lexer::Code code;
+    };
+
+    Entry table[TABLE_SIZE];
+
+    /// Hashes a string of at least two characters.
+    static unsigned hash(const char *str, unsigned length) {
+        uint32_t key = (fold(str[0])               |
+                        fold(str[1])          << 8  |
+                        fold(str[length - 2]) << 16 |
+                        fold(str[length - 1]) << 24);
+        return uint32_t(key * 0xd93527efU) >> (32 - TABLE_BITS);
+    }
+
+    /// Maps upper case letters to lower case.  Other characters never fold
+    /// onto a lower case letter, and so never match a reserved word.
+    static uint32_t fold(char c) {
+        return static_cast<unsigned char>(c) | 0x20;
+    }
+
+    void insert(const char *string, Lexer::Code code);
+};
+
+ReservedWordTable::ReservedWordTable()
 {
-    Code code = UNUSED_ID;
-    const char *str = &nameBuff[0];
-    unsigned length = nameBuff.size();
+    std::memset(table, 0, sizeof(table));
 
-    switch (length) {
-    case 1:
-        if (strncmp(str, "%", length) == 0)
-            code = TKN_PERCENT;
-        break;
+#define RESERVED(NAME, STRING) insert(STRING, Lexer::TKN_ ## NAME);
+#include "comma/parser/Tokens.def"
+#undef RESERVED
+}
 
-    case 2:
-        if (strncmp(str, "is", length) == 0)
-            code = TKN_IS;
-        else if (strncmp(str, "if", length) == 0)
-            code = TKN_IF;
-        else if (strncmp(str, "in", length) == 0)
-            code = TKN_IN;
-        else if (strncmp(str, "of", length) == 0)
-            code = TKN_OF;
-        else if (strncmp(str, "or", length) == 0)
-            code = TKN_OR;
-        break;
+void ReservedWordTable::insert(const char *string, Lexer::Code code)
+{
+    unsigned length = std::strlen(string);
+    Entry &entry = table[hash(string, length)];
+    assert(entry.string == 0 && "Reserved word hash collision!");
+    entry.string = string;
+    entry.length = length;
+    entry.code = code;
+}
 
-    case 3:
-        if (strncmp(str, "end", length) == 0)
-            code = TKN_END;
-        else if (strncmp(str, "out", length) == 0)
-            code = TKN_OUT;
-        else if (strncmp(str, "and", length) == 0)
-            code = TKN_AND;
-        else if (strncmp(str, "mod", length) == 0)
-            code = TKN_MOD;
-        else if (strncmp(str, "rem", length) == 0)
-            code = TKN_REM;
-        else if (strncmp(str, "for", length) == 0)
-            code = TKN_FOR;
-        else if (strncmp(str, "not", length) == 0)
-            code = TKN_NOT;
-        else if (strncmp(str, "xor", length) == 0)
-            code = TKN_XOR;
-        else if (strncmp(str, "new", length) == 0)
-            code = TKN_NEW;
-        else if (strncmp(str, "all", length) == 0)
-            code = TKN_ALL;
-        else if (strncmp(str, "use", length) == 0)
-            code = TKN_USE;
-        break;
+Lexer::Code ReservedWordTable::lookup(const char *str, unsigned length) const
+{
+    if (length < 2)
+        return Lexer::UNUSED_ID;
 
-    case 4:
-        if (strncmp(str, "else", length) == 0)
-            code = TKN_ELSE;
-        else if (strncmp(str, "loop", length) == 0)
-            code = TKN_LOOP;
-        else if (strncmp(str, "then", length) == 0)
-            code = TKN_THEN;
-        else if (strncmp(str, "with", length) == 0)
-            code = TKN_WITH;
-        else if (strncmp(str, "type", length) == 0)
-            code = TKN_TYPE;
-        else if (strncmp(str, "when", length) == 0)
-            code = TKN_WHEN;
-        else if (strncmp(str, "null", length) == 0)
-            code = TKN_NULL;
-        else if (strncmp(str, "exit", length) == 0)
-            code = TKN_EXIT;
-        else if (strncmp(str, "body", length) == 0)
-            code = TKN_BODY;
-        break;
+    const Entry &entry = table[hash(str, length)];
+    if (entry.length != length)
+        return Lexer::UNUSED_ID;
 
-    case 5:
-        if (strncmp(str, "begin", length) == 0)
-            code = TKN_BEGIN;
-        else if (strncmp(str, "elsif", length) == 0)
-            code = TKN_ELSIF;
-        else if (strncmp(str, "while", length) == 0)
-            code = TKN_WHILE;
-        else if (strncmp(str, "range", length) == 0)
-            code = TKN_RANGE;
-        else if (strncmp(str, "array", length) == 0)
-            code = TKN_ARRAY;
-        else if (strncmp(str, "raise", length) == 0)
-            code = TKN_RAISE;
-        break;
+    for (unsigned i = 0; i < length; ++i) {
+        if (fold(str[i]) != static_cast<unsigned char>(entry.string[i]))
+            return Lexer::UNUSED_ID;
+    }
+    return entry.code;
+}
 
-    case 6:
-        if (strncmp(str, "return", length) == 0)
-            code = TKN_RETURN;
-        else if (strncmp(str, "pragma", length) == 0)
-            code = TKN_PRAGMA;
-        else if (strncmp(str, "others", length) == 0)
-            code = TKN_OTHERS;
-        else if (strncmp(str, "record", length) == 0)
-            code = TKN_RECORD;
-        else if (strncmp(str, "access", length) == 0)
-            code = TKN_ACCESS;
-        else if (strncmp(str, "digits", length) == 0)
-            code = TKN_DIGITS;
-        break;
+} // end anonymous namespace.
 
-    case 7:
-        if (strncmp(str, "declare", length) == 0)
-            code = TKN_DECLARE;
-        else if (strncmp(str, "generic", length) == 0)
-            code = TKN_GENERIC;
-        else if (strncmp(str, "package", length) == 0)
-            code = TKN_PACKAGE;
-        else if (strncmp(str, "subtype", length) == 0)
-            code = TKN_SUBTYPE;
-        else if (strncmp(str, "reverse", length) == 0)
-            code = TKN_REVERSE;
-        else if (strncmp(str, "renames", length) == 0)
-            code = TKN_RENAMES;
-        else if (strncmp(str, "private", length) == 0)
-            code = TKN_PRIVATE;
-        else if (strncmp(str, "limited", length) == 0)
-            code = TKN_LIMITED;
-        break;
+Lexer::Code Lexer::getTokenCode() const
+{
+    static const ReservedWordTable reservedWords;
 
-    case 8:
-        if (strncmp(str, "function", length) == 0)
-            code = TKN_FUNCTION;
-        else if (strncmp(str, "abstract", length) == 0)
-            code = TKN_ABSTRACT;
-        break;
+    const char *str = &nameBuff[0];
+    unsigned length = nameBuff.size();
 
-    case 9:
-        if (strncmp(str, "procedure", length) == 0)
-            code = TKN_PROCEDURE;
-        else if (strncmp(str, "exception", length) == 0)
-            code = TKN_EXCEPTION;
-        break;
-    }
-    return code;
+    if (length == 1 && str[0] == '%')
+        return TKN_PERCENT;
+
+    return reservedWords.lookup(str, length);
 }
 
 void Lexer::diagnoseConsecutiveUnderscores(unsigned c1, unsigned c2)
@@ -366,28 +526,41 @@ bool Lexer::consumeName()
 {
     unsigned c1, c2;
 
-    if (isInitialIdentifierChar(c1 = peekStream())) {
-        do {
-            nameBuff.push_back(std::tolower(c1));
-            ignoreStream();
-            c2 = peekStream();
-            diagnoseConsecutiveUnderscores(c1, c2);
-        } while (isInnerIdentifierChar(c1 = c2));
+    if (!isInitialIdentifierChar(c1 = peekStream()))
+        return false;
 
-        return true;
+    for (;;) {
+        // Accumulate the run of characters up to the next underscore.
+        const char *start = &currentIter;
+        const char *end = skipNameChars(start, bufferEnd);
+        unsigned size = nameBuff.size();
+        nameBuff.resize(size + (end - start));
+        foldCase(start, end, nameBuff.begin() + size);
+        currentIter += end - start;
+
+        if ((c1 = peekStream()) != '_')
+            break;
+
+        nameBuff.push_back(c1);
+        ignoreStream();
+        c2 = peekStream();
+        diagnoseConsecutiveUnderscores(c1, c2);
+        if (!isInnerIdentifierChar(peekStream()))
+            break;
     }
-    return false;
+    return true;
 }
 
 bool Lexer::scanName()
 {
     Location loc = currentLocation();
+    TextIterator start = currentIter;
 
     if (consumeName()) {
         Code code = getTokenCode();
 
         if (code == UNUSED_ID)
-            emitIdentifierToken(loc);
+            emitIdentifierToken(loc, start);
         else
             emitToken(code, loc);
         nameBuff.clear();
@@ -403,7 +576,7 @@ void Lexer::scanAttribute(Location loc)
     if (!consumeName())
         report(loc, diag::INVALID_ATTRIBUTE);
 
-    emitAttributeToken(loc);
+    emitAttributeToken(loc, start);
     nameBuff.clear();
 }
 
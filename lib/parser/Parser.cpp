@@ -1214,10 +1214,15 @@ PARSE_CONTEXT:
         goto PARSE_CONTEXT;
 
     case Lexer::TKN_EOT:
+        client.releaseNodeStorage();
         return;
     }
 
     while (parseTopLevelDeclaration()) { }
+
+    // All nodes produced while parsing have been consumed.  Release their
+    // storage in bulk.
+    client.releaseNodeStorage();
 }
 
 // Converts a character array representing a Comma integer literal into an
@@ -107,8 +107,8 @@ void ParserBase::forgetExcursion()
 
 IdentifierInfo *ParserBase::getIdentifierInfo(const Lexer::Token &tkn)
 {
-    llvm::StringRef rep = tkn.getRep();
-    IdentifierInfo *info = &idPool.getIdentifierInfo(rep);
+    llvm::StringRef key = tkn.getKey();
+    IdentifierInfo *info = &idPool.getIdentifierInfo(key);
     return info;
 }
 
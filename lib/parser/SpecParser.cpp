@@ -0,0 +1,124 @@
+//===-- parser/SpecParser.cpp --------------------------------- -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+#include "comma/parser/SpecParser.h"
+
+using namespace comma;
+
+bool SpecParser::atTopLevelForm()
+{
+    switch (currentTokenCode()) {
+    default:
+        return false;
+
+    case Lexer::TKN_WITH:
+    case Lexer::TKN_PACKAGE:
+    case Lexer::TKN_EOT:
+        return true;
+    }
+}
+
+bool SpecParser::parseWithClause(SpecRangeVector &ranges)
+{
+    assert(currentTokenIs(Lexer::TKN_WITH));
+
+    Location start = currentLocation();
+
+    if (!seekToken(Lexer::TKN_SEMI))
+        return false;
+
+    ranges.push_back(SpecRange(start, ignoreToken()));
+    return true;
+}
+
+bool SpecParser::skipPackageBody(IdentifierInfo *name)
+{
+    // Subroutines within the body may share the name of the package.  Keep
+    // scanning until the end tag is followed by the start of a top level form.
+    while (!currentTokenIs(Lexer::TKN_EOT)) {
+        switch (currentTokenCode()) {
+        default:
+            ignoreToken();
+            break;
+
+        case Lexer::TKN_PRAGMA:
+            seenBodyPragma = true;
+            ignoreToken();
+            break;
+
+        case Lexer::TKN_END:
+            ignoreToken();
+            if (currentTokenIs(Lexer::TKN_IDENTIFIER) &&
+                getIdentifierInfo(currentToken()) == name) {
+                ignoreToken();
+                if (reduceToken(Lexer::TKN_SEMI) && atTopLevelForm())
+                    return true;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+bool SpecParser::parsePackage(SpecRangeVector &ranges)
+{
+    assert(currentTokenIs(Lexer::TKN_PACKAGE));
+
+    Location start = ignoreToken();
+    bool isBody = reduceToken(Lexer::TKN_BODY);
+    IdentifierInfo *name = parseIdentifier();
+
+    if (!name)
+        return false;
+
+    if (isBody)
+        return skipPackageBody(name);
+
+    // Package specifications only contain declarations.  The first end tag
+    // naming the package terminates the specification.
+    for (;;) {
+        if (!seekToken(Lexer::TKN_END))
+            return false;
+
+        ignoreToken();
+        if (currentTokenIs(Lexer::TKN_IDENTIFIER) &&
+            getIdentifierInfo(currentToken()) == name)
+            break;
+    }
+
+    ignoreToken();
+    if (!currentTokenIs(Lexer::TKN_SEMI))
+        return false;
+
+    ranges.push_back(SpecRange(start, ignoreToken()));
+    return true;
+}
+
+bool SpecParser::parseSpecification(SpecRangeVector &ranges)
+{
+    for (;;) {
+        switch (currentTokenCode()) {
+
+        default:
+            return false;
+
+        case Lexer::TKN_EOT:
+            return true;
+
+        case Lexer::TKN_WITH:
+            if (!parseWithClause(ranges))
+                return false;
+            break;
+
+        case Lexer::TKN_PACKAGE:
+            if (!parsePackage(ranges))
+                return false;
+            break;
+        }
+    }
+}
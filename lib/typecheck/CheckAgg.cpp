@@ -136,7 +136,8 @@ private:
     ///
     /// Given that keyVec has been populated with static and non-null keys, this
     /// method ensures that there are no overlaps and, when \p hasOthers is
-    /// false, that the keys define a continuous index set.
+    /// false, that the keys define a continuous index set.  The checks are
+    /// performed over a KeyIntervalSet built from keyVec.
     ///
     /// \param contextTy The type context for this aggegate.
     ///
@@ -146,16 +147,6 @@ private:
     /// \return True if the check was successful.
     bool ensureDistinctKeys(ArrayType *contextTy, bool hasOthers);
 
-    /// \brief Helper method for ensureDistinctKeys.
-    ///
-    /// Checks that the sorted ComponentKey's \p X and \p Y do not overlap and,
-    /// if \p requireContinuity is true, that \p X and \p Y represent a
-    /// continuous range.  The comparisons are performed using a signed or
-    /// unsigned interpretation of the component key depending on the setting of
-    /// \p isSigned.
-    bool ensureDistinctKeys(ComponentKey *X, ComponentKey *Y,
-                            bool requireContinuity, bool isSigned);
-
     /// \brief Checks the \c others component (if any) provided by \p agg.
     ///
     /// \return True if the \c others component is well formed with respect to
@@ -375,6 +366,7 @@ Expr *ArrayAggChecker::resolvePositionalAggExpr(AggregateExpr *agg,
 {
     assert(agg->isPurelyPositional());
 
+    AstResource &resource = TC.getAstResource();
     Type *componentType = context->getComponentType();
 
     // Check each component of the aggregate with respect to the component type
@@ -423,9 +415,10 @@ Expr *ArrayAggChecker::resolvePositionalAggExpr(AggregateExpr *agg,
     // aggregate and wrap it in a conversion expression.
     if (context->isConstrained()) {
         ArrayType *unconstrainedTy;
-        unconstrainedTy = TC.getAstResource().createArraySubtype(0, context);
+        unconstrainedTy = resource.createArraySubtype(0, context);
         agg->setType(unconstrainedTy);
-        return new ConversionExpr(agg, context, agg->getLocation(), true);
+        return new (resource) ConversionExpr(agg, context,
+                                             agg->getLocation(), true);
     }
 
     // Otherwise, the context is unconstrained.  Generate a constrained subtype.
@@ -439,25 +432,25 @@ Expr *ArrayAggChecker::resolvePositionalAggExpr(AggregateExpr *agg,
     // values.
     unsigned bits = 32 - llvm::CountLeadingZeros_32(numComponents) + 1;
     llvm::APInt L(bits, numComponents - 1);
-    Expr *arg = new IntegerLiteral(L, Location());
+    Expr *arg = new (resource) IntegerLiteral(L, Location());
 
     // Build a call to the Val attribute.
-    FunctionCallExpr *upper = new FunctionCallExpr(
-        attrib, Location(), &arg, 1, 0, 0);
+    FunctionCallExpr *upper = new (resource) FunctionCallExpr(
+        resource, attrib, Location(), &arg, 1, 0, 0);
 
     // Build an attribute expression for the lower bound.
-    FirstAE *lower = new FirstAE(idxTy, Location());
+    FirstAE *lower = new (resource) FirstAE(idxTy, Location());
 
     // Check the lower and upper bounds in the context of the index type.
     assert(TC.checkExprInContext(lower, idxTy) && "Invalid implicit expr!");
     assert(TC.checkExprInContext(upper, idxTy) && "Invalid implicit expr!");
 
     // Create the discrete subtype for the index.
-    DiscreteType *newIdxTy = TC.getAstResource().createDiscreteSubtype
+    DiscreteType *newIdxTy = resource.createDiscreteSubtype
         (idxTy, lower, upper);
 
     // Finally create and set the new constrained array type for the aggregate.
-    ArrayType *newArrTy = TC.getAstResource().createArraySubtype
+    ArrayType *newArrTy = resource.createArraySubtype
         (context->getIdInfo(), context, &newIdxTy);
 
     agg->setType(newArrTy);
@@ -605,71 +598,30 @@ bool ArrayAggChecker::ensureStaticKeys(AggregateExpr *agg)
     return true;
 }
 
-bool ArrayAggChecker::ensureDistinctKeys(ComponentKey *X, ComponentKey *Y,
-                                         bool requireContinuity, bool isSigned)
+bool ArrayAggChecker::ensureDistinctKeys(ArrayType *contextTy, bool hasOthers)
 {
-    llvm::APInt xValue;
-    llvm::APInt yValue;
-    X->getUpperValue(xValue);
-    Y->getLowerValue(yValue);
-
-    bool overlapping;
-    bool continuous;
-    if (isSigned) {
-        int64_t x = xValue.getSExtValue();
-        int64_t y = yValue.getSExtValue();
-        overlapping = y <= x;
-        continuous = x == y - 1;
-    }
-    else {
-        uint64_t x = xValue.getZExtValue();
-        uint64_t y = yValue.getZExtValue();
-        overlapping = y <= x;
-        continuous = x == y - 1;
-    }
+    DiscreteType *indexTy = contextTy->getIndexType(0);
+    KeyIntervalSet keySet(keyVec.begin(), keyVec.end(), indexTy->isSigned());
+    ComponentKey *X;
+    ComponentKey *Y;
+
+    if (keySet.empty())
+        return true;
 
     // Diagnose overlapping indices.
-    if (overlapping) {
+    if (keySet.getOverlap(X, Y)) {
         report(X->getLocation(), diag::DUPLICATED_AGGREGATE_COMPONENT)
             << getSourceLoc(Y->getLocation());
         return false;
     }
 
     // Diagnose non-continuous indices when required.
-    if (requireContinuity && !continuous) {
+    if (!hasOthers && keySet.getDiscontinuity(X, Y)) {
         report(X->getLocation(), diag::DISCONTINUOUS_CHOICE)
             << getSourceLoc(Y->getLocation());
         return false;
     }
 
-    return true;
-}
-
-bool ArrayAggChecker::ensureDistinctKeys(ArrayType *contextTy, bool hasOthers)
-{
-    DiscreteType *indexTy = contextTy->getIndexType(0);
-    bool isSigned = indexTy->isSigned();
-    bool requireContinuity = !hasOthers;
-
-    if (isSigned)
-        std::sort(keyVec.begin(), keyVec.end(), ComponentKey::compareKeysS);
-    else
-        std::sort(keyVec.begin(), keyVec.end(), ComponentKey::compareKeysU);
-
-    std::vector<ComponentKey*>::iterator I = keyVec.begin();
-    std::vector<ComponentKey*>::iterator E = keyVec.end();
-
-    if (I == E)
-        return true;
-
-    ComponentKey *prev = *I;
-    while (++I != E) {
-        ComponentKey *next = *I;
-        if (!ensureDistinctKeys(prev, next, requireContinuity, isSigned))
-            return false;
-        prev = next;
-    }
-
     // If the context type of the aggregate is unconstrained then generate a new
     // constrained subtype for the current index.
     //
@@ -677,8 +629,8 @@ bool ArrayAggChecker::ensureDistinctKeys(ArrayType *contextTy, bool hasOthers)
     // the new subtype will take ownership.
     if (!contextTy->isConstrained()) {
         AstResource &resource = TC.getAstResource();
-        Expr *lower = keyVec.front()->getLowerExpr();
-        Expr *upper = keyVec.back()->getUpperExpr();
+        Expr *lower = keySet.getFirstKey()->getLowerExpr();
+        Expr *upper = keySet.getLastKey()->getUpperExpr();
         refinedIndexType = resource.createDiscreteSubtype(
             indexTy, lower, upper);
     }
@@ -984,7 +936,7 @@ Expr *TypeCheck::resolveAggregateExpr(AggregateExpr *agg, Type *context)
 
 void TypeCheck::beginAggregate(Location loc)
 {
-    aggregateStack.push(new AggregateExpr(loc));
+    aggregateStack.push(new (resource) AggregateExpr(loc));
 }
 
 void TypeCheck::acceptPositionalAggregateComponent(Node nodeComponent)
@@ -1006,14 +958,16 @@ Node TypeCheck::acceptAggregateKey(Node lowerNode, Node upperNode)
     // given.  Build an untyped range to hold onto the bounds.
     lowerNode.release();
     upperNode.release();
-    return getNode(new ComponentKey(new Range(lower, upper)));
+    Range *range = new (resource) Range(lower, upper);
+    return getNode(new (resource) ComponentKey(range));
 }
 
 Node TypeCheck::acceptAggregateKey(IdentifierInfo *name, Location loc)
 {
     // Construct a ComponentKey over an IdentifierNode.  Such keys are resolved
     // during the top-down phase.
-    return getNode(new ComponentKey(new Identifier(name, loc)));
+    Identifier *id = new (resource) Identifier(name, loc);
+    return getNode(new (resource) ComponentKey(id));
 }
 
 Node TypeCheck::acceptAggregateKey(Node keyNode)
@@ -1032,7 +986,7 @@ Node TypeCheck::acceptAggregateKey(Node keyNode)
             return getInvalidNode();
         }
         keyNode.release();
-        return getNode(new ComponentKey(ref));
+        return getNode(new (resource) ComponentKey(ref));
     }
 
     Expr *expr = ensureExpr(keyNode);
@@ -1040,7 +994,7 @@ Node TypeCheck::acceptAggregateKey(Node keyNode)
         return getInvalidNode();
 
     keyNode.release();
-    return getNode(new ComponentKey(expr));
+    return getNode(new (resource) ComponentKey(expr));
 }
 
 void TypeCheck::acceptKeyedAggregateComponent(NodeVector &keyNodes,
@@ -1072,8 +1026,8 @@ void TypeCheck::acceptKeyedAggregateComponent(NodeVector &keyNodes,
     exprNode.release();
     ComponentKeyList *KL;
     if (expr == 0)
-        expr = new DiamondExpr(loc);
-    KL = ComponentKeyList::create(&keys[0], keys.size(), expr);
+        expr = new (resource) DiamondExpr(loc);
+    KL = ComponentKeyList::create(resource, &keys[0], keys.size(), expr);
     aggregateStack.top()->addComponent(KL);
 }
 
@@ -1083,7 +1037,7 @@ void TypeCheck::acceptAggregateOthers(Location loc, Node nodeComponent)
     Expr *component = 0;
 
     if (nodeComponent.isNull())
-        component = new DiamondExpr(loc);
+        component = new (resource) DiamondExpr(loc);
     else
         component = ensureExpr(nodeComponent);
 
@@ -1120,7 +1074,7 @@ Node TypeCheck::acceptStringLiteral(const char *chars, unsigned len,
 
     const char *I = chars + 1;
     const char *E = chars + len - 1;
-    StringLiteral *string = new StringLiteral(I, E, loc);
+    StringLiteral *string = new (resource) StringLiteral(resource, I, E, loc);
 
     char buff[3] = { '\'', 0, '\'' };
     typedef llvm::SmallVector<EnumerationDecl*, 8> LitVec;
@@ -155,9 +155,9 @@ ScalarBoundAE *AttributeChecker::checkScalarBound(TypeRef *prefix, Location loc)
     }
 
     if (ID == attrib::First)
-        return new FirstAE(prefixTy, loc);
+        return new (resource) FirstAE(prefixTy, loc);
     else
-        return new LastAE(prefixTy, loc);
+        return new (resource) LastAE(prefixTy, loc);
 }
 
 ArrayBoundAE *AttributeChecker::checkArrayBound(Expr *prefix, Location loc)
@@ -166,9 +166,9 @@ ArrayBoundAE *AttributeChecker::checkArrayBound(Expr *prefix, Location loc)
         return 0;
 
     if (ID == attrib::First)
-        return new FirstArrayAE(prefix, loc);
+        return new (resource) FirstArrayAE(prefix, loc);
     else
-        return new LastArrayAE(prefix, loc);
+        return new (resource) LastArrayAE(prefix, loc);
 }
 
 RangeAttrib *AttributeChecker::checkRange(Ast *prefix, Location loc)
@@ -176,7 +176,7 @@ RangeAttrib *AttributeChecker::checkRange(Ast *prefix, Location loc)
     // If the prefix denotes an expression it must resolve to an array type.
     if (Expr *expr = dyn_cast<Expr>(prefix)) {
         if ((expr = resolveArrayType(expr, loc)))
-            return new ArrayRangeAttrib(expr, loc);
+            return new (resource) ArrayRangeAttrib(expr, loc);
         return 0;
     }
 
@@ -197,7 +197,7 @@ RangeAttrib *AttributeChecker::checkRange(Ast *prefix, Location loc)
     }
 
     delete ref;
-    return new ScalarRangeAttrib(prefixTy, loc);
+    return new (resource) ScalarRangeAttrib(prefixTy, loc);
 }
 
 SubroutineRef *AttributeChecker::checkPosVal(Ast *prefix, Location loc)
@@ -225,7 +225,7 @@ SubroutineRef *AttributeChecker::checkPosVal(Ast *prefix, Location loc)
     }
 
     delete ref;
-    return new SubroutineRef(loc, attrib);
+    return new (resource) SubroutineRef(loc, attrib);
 }
 
 Expr *AttributeChecker::checkLength(Ast *prefix, Location loc)
@@ -238,7 +238,7 @@ Expr *AttributeChecker::checkLength(Ast *prefix, Location loc)
     if (!(expr = resolveArrayType(expr, loc)))
         return 0;
 
-    return new LengthAE(expr, loc);
+    return new (resource) LengthAE(expr, loc);
 }
 
 Expr *AttributeChecker::resolveArrayType(Expr *expr, Location loc)
@@ -325,7 +325,7 @@ Expr *AttributeChecker::resolveAttribute(AttribExpr *attrib, Type *context)
     }
 
     length->setType(rootTy);
-    return new ConversionExpr(length, context, loc, true);
+    return new (resource) ConversionExpr(length, context, loc, true);
 }
 
 } // end anonymous namespace.
@@ -18,6 +18,8 @@
 #include "comma/ast/DiagPrint.h"
 #include "comma/ast/Stmt.h"
 
+#include "llvm/ADT/SmallPtrSet.h"
+
 using namespace comma;
 using llvm::dyn_cast;
 using llvm::cast;
@@ -45,18 +47,20 @@ bool routineAcceptsKeywords(SubroutineDecl *decl,
 /// Builds either a function call or procedure call node depending on the
 /// contents of the given SubroutineRef.
 SubroutineCall *
-makeSubroutineCall(SubroutineRef *ref,
+makeSubroutineCall(AstResource &resource, SubroutineRef *ref,
                    Expr **positionalArgs, unsigned numPositional,
                    KeywordSelector **keyedArgs, unsigned numKeys)
 {
     assert(!ref->empty() && "Empty subroutine reference!");
 
     if (ref->referencesFunctions())
-        return new FunctionCallExpr(ref, positionalArgs, numPositional,
-                                    keyedArgs, numKeys);
+        return new (resource) FunctionCallExpr(resource, ref,
+                                               positionalArgs, numPositional,
+                                               keyedArgs, numKeys);
     else
-        return new ProcedureCallStmt(ref, positionalArgs, numPositional,
-                                     keyedArgs, numKeys);
+        return new (resource) ProcedureCallStmt(resource, ref,
+                                                positionalArgs, numPositional,
+                                                keyedArgs, numKeys);
 }
 
 /// Injects implicit ConversionExpr nodes into the positional and keyword
@@ -104,6 +108,84 @@ void convertSubroutineCallArguments(TypeCheck *TC, SubroutineCall *call)
     }
 }
 
+/// \class
+/// \brief Indexes the interpretations of an ambiguous function call by the
+/// root of their return types.
+///
+/// When an ambiguous call is an argument to an overloaded subroutine, each
+/// overload is checked for a parameter type covering some interpretation of
+/// the call.  For heavily overloaded operators, scanning every interpretation
+/// for every overload is quadratic.  With the interpretations bucketed by root
+/// type, most parameter types are checked with a single lookup.  Return types
+/// for which coverage is not a simple comparison of root types (universal and
+/// private types) are kept aside and checked individually.
+class ReturnTypeIndex {
+
+public:
+    /// Indexes the interpretations of the given call.  If \p call is null
+    /// the index is empty.
+    ReturnTypeIndex(FunctionCallExpr *call);
+
+    /// Returns true if some interpretation of the call is covered by the given
+    /// target type.
+    bool covers(TypeCheck *TC, Type *targetType) const;
+
+private:
+    typedef llvm::SmallPtrSet<Type*, 16> RootSet;
+    RootSet roots;
+
+    typedef llvm::SmallVector<Type*, 4> TypeVector;
+    TypeVector others;
+
+    /// Returns the root of the given type, or null if coverage of the type is
+    /// not determined by its root.
+    static Type *getIndexableRoot(Type *type);
+};
+
+ReturnTypeIndex::ReturnTypeIndex(FunctionCallExpr *call)
+{
+    if (!call)
+        return;
+
+    typedef FunctionCallExpr::fun_iterator iterator;
+    iterator I = call->begin_functions();
+    iterator E = call->end_functions();
+    for ( ; I != E; ++I) {
+        Type *returnType = (*I)->getReturnType();
+        if (Type *root = getIndexableRoot(returnType))
+            roots.insert(root);
+        else
+            others.push_back(returnType);
+    }
+}
+
+Type *ReturnTypeIndex::getIndexableRoot(Type *type)
+{
+    if (isa<PrivateType>(type))
+        return 0;
+    if (PrimaryType *primary = dyn_cast<PrimaryType>(type))
+        return primary->getRootType();
+    return 0;
+}
+
+bool ReturnTypeIndex::covers(TypeCheck *TC, Type *targetType) const
+{
+    if (Type *root = getIndexableRoot(targetType)) {
+        if (roots.count(root))
+            return true;
+    }
+    else {
+        for (RootSet::const_iterator I = roots.begin(); I != roots.end(); ++I)
+            if (TC->covers(*I, targetType))
+                return true;
+    }
+
+    for (TypeVector::const_iterator I = others.begin(); I != others.end(); ++I)
+        if (TC->covers(*I, targetType))
+            return true;
+    return false;
+}
+
 } // End anonymous namespace.
 
 bool TypeCheck::checkApplicableArgument(Expr *arg, Type *targetType)
@@ -148,39 +230,33 @@ bool TypeCheck::checkApplicableArgument(Expr *arg, Type *targetType)
     return false;
 }
 
-/// Checks that the given subroutine decl accepts the provided positional
-/// arguments.
-bool TypeCheck::routineAcceptsArgs(SubroutineDecl *decl,
-                                   SVImpl<Expr*>::Type &args)
+void TypeCheck::filterByApplicableArgument(SubroutineRef *ref, Expr *arg,
+                                           unsigned index, IdentifierInfo *key)
 {
-    unsigned numArgs = args.size();
-    for (unsigned i = 0; i < numArgs; ++i) {
-        Expr *arg = args[i];
-        Type *targetType = decl->getParamType(i);
-        if (!checkApplicableArgument(arg, targetType))
-            return false;
-    }
-    return true;
-}
+    // An ambiguous call is indexed once and checked against each declaration
+    // with the index.  This mirrors the final case of checkApplicableArgument.
+    FunctionCallExpr *call = dyn_cast<FunctionCallExpr>(arg);
+    if (call && call->hasType())
+        call = 0;
+    ReturnTypeIndex returnTypes(call);
 
-/// Checks that the given subroutine decl accepts the provided keyword
-/// arguments.
-bool
-TypeCheck::routineAcceptsArgs(SubroutineDecl *decl,
-                              SVImpl<KeywordSelector*>::Type &args)
-{
-    unsigned numKeys = args.size();
-    for (unsigned i = 0; i < numKeys; ++i) {
-        KeywordSelector *selector = args[i];
-        Expr *arg = selector->getExpression();
-        IdentifierInfo *key = selector->getKeyword();
-        unsigned targetIndex = decl->getKeywordIndex(key);
+    SubroutineRef::iterator I = ref->begin();
+    while (I != ref->end()) {
+        SubroutineDecl *decl = *I;
+        unsigned targetIndex = key ? decl->getKeywordIndex(key) : index;
         Type *targetType = decl->getParamType(targetIndex);
+        bool applicable;
 
-        if (!checkApplicableArgument(arg, targetType))
-            return false;
+        if (call)
+            applicable = returnTypes.covers(this, targetType);
+        else
+            applicable = checkApplicableArgument(arg, targetType);
+
+        if (applicable)
+            ++I;
+        else
+            I = ref->erase(I);
     }
-    return true;
 }
 
 Ast* TypeCheck::acceptSubroutineCall(SubroutineRef *ref,
@@ -218,25 +294,15 @@ Ast* TypeCheck::acceptSubroutineCall(SubroutineRef *ref,
     }
 
     // Reduce the set of declarations with respect to the types of the
-    // arguments.
-    for (I = ref->begin(); I != ref->end();) {
-        SubroutineDecl *decl = *I;
-
-        // First process the positional parameters.  Move on to the next
-        // declaration if is cannot accept the given arguments.
-        if (!routineAcceptsArgs(decl, positionalArgs)) {
-            I = ref->erase(I);
-            continue;
-        }
-
-        // Check the keyed arguments for compatibility.
-        if (!routineAcceptsArgs(decl, keyedArgs)) {
-            I = ref->erase(I);
-            continue;
-        }
-
-        // We have a compatible declaration.
-        ++I;
+    // arguments.  Each argument is checked against all remaining declarations
+    // in turn so that any work specific to the argument is done only once.
+    for (unsigned i = 0; i < numPositional && !ref->empty(); ++i)
+        filterByApplicableArgument(ref, positionalArgs[i], i, 0);
+
+    for (unsigned i = 0; i < numKeys && !ref->empty(); ++i) {
+        KeywordSelector *selector = keyedArgs[i];
+        filterByApplicableArgument(ref, selector->getExpression(), 0,
+                                   selector->getKeyword());
     }
 
     // If all of the declarations have been filtered out, it is due to ambiguous
@@ -263,7 +329,7 @@ Ast* TypeCheck::acceptSubroutineCall(SubroutineRef *ref,
     }
 
     SubroutineCall *call =
-        makeSubroutineCall(ref,
+        makeSubroutineCall(resource, ref,
                            positionalArgs.data(), numPositional,
                            keyedArgs.data(), numKeys);
     return call->asAst();
@@ -346,7 +412,7 @@ TypeCheck::checkSubroutineCall(SubroutineRef *ref,
         return 0;
 
     convertSubroutineArguments(this, decl, posArgs, keyArgs);
-    return makeSubroutineCall(ref, posArgs.data(), posArgs.size(),
+    return makeSubroutineCall(resource, ref, posArgs.data(), posArgs.size(),
                               keyArgs.data(), keyArgs.size());
 }
 
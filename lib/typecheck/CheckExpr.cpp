@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "RangeAnalysis.h"
 #include "Scope.h"
 #include "TypeCheck.h"
 #include "comma/ast/AttribExpr.h"
@@ -62,7 +63,8 @@ IndexedArrayExpr *TypeCheck::acceptIndexedArray(Expr *expr,
         // the accompanying type context.  Since we will be checking the node
         // entirely at that time simply construct the expression with an
         // unresolved type without checks.
-        return new IndexedArrayExpr(expr, &indices[0], indices.size());
+        return new (resource) IndexedArrayExpr(resource, expr,
+                                               &indices[0], indices.size());
     }
 
     ArrayType *arrTy;
@@ -99,7 +101,8 @@ IndexedArrayExpr *TypeCheck::acceptIndexedArray(Expr *expr,
     if (allOK) {
         if (requiresDereference)
             expr = implicitlyDereference(expr, arrTy);
-        return new IndexedArrayExpr(expr, &indices[0], numIndices);
+        return new (resource) IndexedArrayExpr(resource, expr,
+                                               &indices[0], numIndices);
     }
     else
         return 0;
@@ -300,7 +303,8 @@ Expr *TypeCheck::resolveIntegerLiteral(IntegerLiteral *intLit, Type *context)
     }
 
     intLit->setType(rootTy);
-    return new ConversionExpr(intLit, context, intLit->getLocation(), true);
+    return new (resource) ConversionExpr(intLit, context,
+                                         intLit->getLocation(), true);
 }
 
 Expr *TypeCheck::resolveNullExpr(NullExpr *expr, Type *context)
@@ -400,7 +404,7 @@ Node TypeCheck::acceptIntegerLiteral(llvm::APInt &value, Location loc)
     if (value != 0)
         value.zext(value.getBitWidth() + 1);
 
-    return getNode(new IntegerLiteral(value, loc));
+    return getNode(new (resource) IntegerLiteral(value, loc));
 }
 
 Node TypeCheck::acceptNullExpr(Location loc)
@@ -408,7 +412,7 @@ Node TypeCheck::acceptNullExpr(Location loc)
     // We cannot type check null expression until a context has been
     // extablished.  Simply return an expression node and defer checking until
     // the top-down pass.
-    return getNode(new NullExpr(loc));
+    return getNode(new (resource) NullExpr(loc));
 }
 
 Node TypeCheck::acceptAllocatorExpr(Node operandNode, Location loc)
@@ -417,7 +421,7 @@ Node TypeCheck::acceptAllocatorExpr(Node operandNode, Location loc)
 
     if (QualifiedExpr *qual = lift_node<QualifiedExpr>(operandNode)) {
         operandNode.release();
-        alloc = new AllocatorExpr(qual, loc);
+        alloc = new (resource) AllocatorExpr(qual, loc);
     }
     else {
         STIndication *STI = cast_node<STIndication>(operandNode);
@@ -429,7 +433,7 @@ Node TypeCheck::acceptAllocatorExpr(Node operandNode, Location loc)
             return getInvalidNode();
         }
         else
-            alloc = new AllocatorExpr(STI->getType(), loc);
+            alloc = new (resource) AllocatorExpr(STI->getType(), loc);
     }
 
     return getNode(alloc);
@@ -452,7 +456,8 @@ Node TypeCheck::acceptQualifiedExpr(Node qualifierNode, Node exprNode)
     qualifierNode.release();
     exprNode.release();
     QualifiedExpr *result;
-    result = new QualifiedExpr(prefix, expr, getNodeLoc(qualifierNode));
+    result = new (resource) QualifiedExpr(prefix, expr,
+                                          getNodeLoc(qualifierNode));
     return getNode(result);
 }
 
@@ -467,7 +472,7 @@ Node TypeCheck::acceptDereference(Node prefixNode, Location loc)
         return getInvalidNode();
 
     prefixNode.release();
-    DereferenceExpr *deref = new DereferenceExpr(expr, loc);
+    DereferenceExpr *deref = new (resource) DereferenceExpr(expr, loc);
     return getNode(deref);
 }
 
@@ -500,18 +505,24 @@ ConversionExpr *TypeCheck::acceptConversionExpr(TypeRef *prefix,
     // FIXME: Perhaps a note mentioning redundant conversion should be posted
     // here.
     if (covers(sourceTy, targetTy))
-        return new ConversionExpr(arg, targetTy, prefix->getLocation(), false);
+        return new (resource) ConversionExpr(arg, targetTy,
+                                             prefix->getLocation(), false);
 
     // Numeric conversions.
-    if (sourceTy->isNumericType() && targetTy->isNumericType())
-        return new ConversionExpr(arg, targetTy, prefix->getLocation(), false);
+    if (sourceTy->isNumericType() && targetTy->isNumericType()) {
+        ConversionExpr *conv = new (resource) ConversionExpr(
+            arg, targetTy, prefix->getLocation(), false);
+        RangeAnalysis::annotateConversion(conv);
+        return conv;
+    }
 
     // Access conversions.
     //
     // FIXME:  There is much more to do here, but the following is fine for the
     // current implementation.
     if (sourceTy->isAccessType() && targetTy->isAccessType())
-        return new ConversionExpr(arg, targetTy, prefix->getLocation(), false);
+        return new (resource) ConversionExpr(arg, targetTy,
+                                             prefix->getLocation(), false);
 
     report(prefix->getLocation(), diag::INVALID_CONVERSION)
         << diag::PrintType(sourceTy) << diag::PrintType(targetTy);
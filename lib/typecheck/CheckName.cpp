@@ -27,14 +27,15 @@ namespace {
 
 /// Utility routine for building SubroutineRef nodes using the subroutine
 /// declarations provided by the given Resolver.
-SubroutineRef *buildSubroutineRef(Location loc, Resolver &resolver)
+SubroutineRef *buildSubroutineRef(AstResource &resource,
+                                  Location loc, Resolver &resolver)
 {
     llvm::SmallVector<SubroutineDecl *, 8> routines;
     resolver.getVisibleSubroutines(routines);
 
     if (routines.empty())
         return 0;
-    return new SubroutineRef(loc, &routines[0], routines.size());
+    return new (resource) SubroutineRef(loc, &routines[0], routines.size());
 }
 
 } // end anonymous namespace.
@@ -44,12 +45,12 @@ Ast *TypeCheck::checkIndirectName(Location loc, Resolver &resolver)
     // Check if there is a unique indirect type.
     if (resolver.hasVisibleIndirectType()) {
         TypeDecl *tdecl = resolver.getIndirectType(0);
-        return new TypeRef(loc, tdecl);
+        return new (resource) TypeRef(loc, tdecl);
     }
 
     // Check if there are any indirect functions.
     if (resolver.hasVisibleIndirectOverloads()) {
-        if (SubroutineRef *ref = buildSubroutineRef(loc, resolver))
+        if (SubroutineRef *ref = buildSubroutineRef(resource, loc, resolver))
             return ref;
         else {
             report(loc, diag::NAME_NOT_VISIBLE) << resolver.getIdInfo();
@@ -92,25 +93,25 @@ Ast *TypeCheck::checkDirectName(IdentifierInfo *name, Location loc,
     // If there is a direct value, it shadows all other names.
     if (resolver.hasDirectValue()) {
         ValueDecl *vdecl = resolver.getDirectValue();
-        return new DeclRefExpr(vdecl, loc);
+        return new (resource) DeclRefExpr(vdecl, loc);
     }
 
     // If there is a direct type, it shadows all other names.
     if (resolver.hasDirectType()) {
         TypeDecl *tdecl = resolver.getDirectType();
-        return new TypeRef(loc, tdecl);
+        return new (resource) TypeRef(loc, tdecl);
     }
 
     // If there is a direct exception, it shadows all other names.
     if (resolver.hasDirectException()) {
         ExceptionDecl *edecl = resolver.getDirectException();
-        return new ExceptionRef(loc, edecl);
+        return new (resource) ExceptionRef(loc, edecl);
     }
 
     // Ditto for direct packages.
     if (resolver.hasDirectPackage()) {
         PackageDecl *package = resolver.getDirectPackage();
-        return new PackageRef(loc, package->getInstance());
+        return new (resource) PackageRef(loc, package->getInstance());
     }
 
     // Filter the subroutines depending on what kind of name we are trying to
@@ -123,7 +124,7 @@ Ast *TypeCheck::checkDirectName(IdentifierInfo *name, Location loc,
     // If there are direct subroutines (possibly several), build a SubroutineRef
     // to encapsulate them.
     if (resolver.hasDirectOverloads()) {
-        if (SubroutineRef *ref = buildSubroutineRef(loc, resolver))
+        if (SubroutineRef *ref = buildSubroutineRef(resource, loc, resolver))
             return ref;
         else {
             report(loc, diag::NAME_NOT_VISIBLE) << name;
@@ -145,10 +146,10 @@ Ast *TypeCheck::processExpandedName(DeclRegion *region,
                                     IdentifierInfo *name, Location loc,
                                     bool forStatement)
 {
-    // Scan the entire set of declaration nodes, matching against the components
-    // with the given name.  In addition, look for enumeration declarations
-    // which in turn provide a literal of the given name.  This allows the
-    // "short hand qualification" of enumeration literals.  For example, given:
+    // Match against the declarations with the given name.  In addition, look
+    // for enumeration declarations which in turn provide a literal of the
+    // given name.  This allows the "short hand qualification" of enumeration
+    // literals.  For example, given:
     //
     //   package P is type T is (X); end P;
     //
@@ -158,31 +159,38 @@ Ast *TypeCheck::processExpandedName(DeclRegion *region,
     // name).
     llvm::SmallVector<SubroutineDecl*, 8> overloads;
 
-    for (DeclRegion::DeclIter I = region->beginDecls(), E = region->endDecls();
-         I != E; ++I) {
+    DeclRegion::PredRange range = region->findDecls(name);
+    for (DeclRegion::PredIter I = range.first; I != range.second; ++I) {
         Decl *decl = *I;
 
-        if (decl->getIdInfo() == name) {
-            // DeclRegions provide at most a single type with the given name or
-            // a set of overloaded subroutines (we do not yet support values at
-            // this time).
-            if (TypeDecl *tdecl = dyn_cast<TypeDecl>(decl)) {
-                assert(overloads.empty() && "Inconsistent DeclRegion!");
-                return new TypeRef(loc, tdecl);
-            }
+        // DeclRegions provide at most a single type with the given name or a
+        // set of overloaded subroutines (we do not yet support values at this
+        // time).
+        if (TypeDecl *tdecl = dyn_cast<TypeDecl>(decl)) {
+            assert(overloads.empty() && "Inconsistent DeclRegion!");
+            return new (resource) TypeRef(loc, tdecl);
+        }
 
-            // Distinguish functions from procedures if we are generiating a
-            // name for use as a statement.
-            if (forStatement) {
-                if (SubroutineDecl *routine = dyn_cast<SubroutineDecl>(decl))
-                    overloads.push_back(routine);
-            }
-            else {
-                if (SubroutineDecl *routine = dyn_cast<FunctionDecl>(decl))
-                    overloads.push_back(routine);
-            }
+        // Distinguish functions from procedures if we are generiating a name
+        // for use as a statement.
+        if (forStatement) {
+            if (SubroutineDecl *routine = dyn_cast<SubroutineDecl>(decl))
+                overloads.push_back(routine);
         }
-        else if (EnumerationDecl *edecl = dyn_cast<EnumerationDecl>(*I)) {
+        else {
+            if (SubroutineDecl *routine = dyn_cast<FunctionDecl>(decl))
+                overloads.push_back(routine);
+        }
+    }
+
+    // Package instances materialize their declarations on demand.  Ensure the
+    // enumerations providing a matching literal are present.
+    if (PkgInstanceDecl *instance = dyn_cast<PkgInstanceDecl>(region))
+        instance->materializeLiteral(name);
+
+    for (DeclRegion::DeclIter I = region->beginDecls(), E = region->endDecls();
+         I != E; ++I) {
+        if (EnumerationDecl *edecl = dyn_cast<EnumerationDecl>(*I)) {
             if (EnumLiteral *lit = edecl->findLiteral(name))
                 overloads.push_back(lit);
         }
@@ -193,7 +201,7 @@ Ast *TypeCheck::processExpandedName(DeclRegion *region,
         return 0;
     }
 
-    return new SubroutineRef(loc, &overloads[0], overloads.size());
+    return new (resource) SubroutineRef(loc, &overloads[0], overloads.size());
 }
 
 Ast *TypeCheck::processSelectedComponent(Expr *expr,
@@ -203,7 +211,7 @@ Ast *TypeCheck::processSelectedComponent(Expr *expr,
     // If the prefix expression does not have a resolved type we must wait for
     // the top down pass.  Construct an ambiguous selectedExpr node and return.
     if (!expr->hasResolvedType())
-        return new SelectedExpr(expr, name, loc);
+        return new (resource) SelectedExpr(expr, name, loc);
 
     RecordType *prefixTy;
     Type *exprTy = resolveType(expr->getType());
@@ -231,7 +239,8 @@ Ast *TypeCheck::processSelectedComponent(Expr *expr,
 
     if (requiresDereference)
         expr = implicitlyDereference(expr, prefixTy);
-    return new SelectedExpr(expr, component, loc, component->getType());
+    return new (resource) SelectedExpr(expr, component, loc,
+                                       component->getType());
 }
 
 Node TypeCheck::acceptSelectedComponent(Node prefix,
@@ -268,14 +277,16 @@ Node TypeCheck::acceptParameterAssociation(IdentifierInfo *key, Location loc,
 {
     // Parameter associations can be built with an Expr on the rhs.
     if (Expr *expr = lift_node<Expr>(rhs)) {
-        KeywordSelector *selector = new KeywordSelector(key, loc, expr);
+        KeywordSelector *selector =
+            new (resource) KeywordSelector(key, loc, expr);
         rhs.release();
         return getNode(selector);
     }
 
     // Or with a TypeRef.
     if (TypeRef *ref = lift_node<TypeRef>(rhs)) {
-        KeywordSelector *selector = new KeywordSelector(key, loc, ref);
+        KeywordSelector *selector =
+            new (resource) KeywordSelector(key, loc, ref);
         rhs.release();
         return getNode(selector);
     }
@@ -419,7 +430,7 @@ Ast *TypeCheck::acceptSubroutineApplication(SubroutineRef *ref,
                 FunctionCallExpr *call;
                 IndexedArrayExpr *iae;
                 ref->addDeclaration(interps[0]);
-                call = new FunctionCallExpr(ref);
+                call = new (resource) FunctionCallExpr(resource, ref);
                 if (!(iae = acceptIndexedArray(call, posArgs)))
                     delete call;
                 return iae;
@@ -430,8 +441,10 @@ Ast *TypeCheck::acceptSubroutineApplication(SubroutineRef *ref,
             // expression.
             FunctionCallExpr *call;
             ref->addDeclarations(interps.begin(), interps.end());
-            call = new FunctionCallExpr(ref);
-            return new IndexedArrayExpr(call, posArgs.data(), posArgs.size());
+            call = new (resource) FunctionCallExpr(resource, ref);
+            return new (resource) IndexedArrayExpr(resource, call,
+                                                   posArgs.data(),
+                                                   posArgs.size());
         }
     }
     else {
@@ -537,9 +550,9 @@ Ast *TypeCheck::finishSubroutineRef(SubroutineRef *ref)
     // and verify the return type.  Procedures, on the other hand, must resolve
     // uniquely.
     if (ref->referencesFunctions())
-        return new FunctionCallExpr(ref, 0, 0, 0, 0);
+        return new (resource) FunctionCallExpr(resource, ref, 0, 0, 0, 0);
     else if (ref->isResolved())
-        return new ProcedureCallStmt(ref, 0, 0, 0, 0);
+        return new (resource) ProcedureCallStmt(resource, ref, 0, 0, 0, 0);
     else {
         report(loc, diag::AMBIGUOUS_EXPRESSION);
         for (SubroutineRef::iterator I = ref->begin(); I != ref->end(); ++I)
@@ -48,7 +48,7 @@ void TypeCheck::acquireImplicitDeclarations(Decl *decl)
 
 bool TypeCheck::beginPackageSpec(IdentifierInfo *name, Location loc)
 {
-    PackageDecl *package = new PackageDecl(resource, name, loc);
+    PackageDecl *package = new (resource) PackageDecl(resource, name, loc);
     scope.push(PACKAGE_SCOPE);
     currentPackage = package;
     declarativeRegion = package;
@@ -63,7 +63,7 @@ void TypeCheck::beginPackagePrivatePart(Location loc)
 
     // Simply set the declarative region to a new PrivatePart node.  The private
     // part of a package is not a new scope.
-    declarativeRegion = new PrivatePart(currentPackage, loc);
+    declarativeRegion = new (resource) PrivatePart(currentPackage, loc);
 }
 
 void TypeCheck::endPackageSpec()
@@ -118,7 +118,7 @@ bool TypeCheck::beginPackageBody(IdentifierInfo *name, Location loc)
 
     // Construct the package body.  The BodyDecl automatically registers itself
     // with the package.
-    BodyDecl *body = new BodyDecl(package, loc);
+    BodyDecl *body = new (resource) BodyDecl(package, loc);
 
     // Setup the environment.
     scope.push(PACKAGE_SCOPE);
@@ -61,7 +61,7 @@ Node TypeCheck::acceptReturnStmt(Location loc, Node retNode)
 
         if ((retExpr = checkExprInContext(retExpr, targetType))) {
             retNode.release();
-            return getNode(new ReturnStmt(loc, retExpr));
+            return getNode(new (resource) ReturnStmt(loc, retExpr));
         }
         return getInvalidNode();
     }
@@ -76,7 +76,7 @@ Node TypeCheck::acceptEmptyReturnStmt(Location loc)
            "Return statement outside subroutine context!");
 
     if (checkingProcedure())
-        return getNode(new ReturnStmt(loc));
+        return getNode(new (resource) ReturnStmt(loc));
 
     report(loc, diag::EMPTY_RETURN_IN_FUNCTION);
     return getInvalidNode();
@@ -115,7 +115,7 @@ Node TypeCheck::acceptAssignmentStmt(Node targetNode, Node valueNode)
     valueNode.release();
     targetNode.release();
     value = convertIfNeeded(value, targetTy);
-    return getNode(new AssignmentStmt(target, value));
+    return getNode(new (resource) AssignmentStmt(target, value));
 }
 
 Node TypeCheck::acceptIfStmt(Location loc, Node conditionNode,
@@ -132,11 +132,11 @@ Node TypeCheck::acceptIfStmt(Location loc, Node conditionNode,
     if ((pred = checkExprInContext(pred, resource.getTheBooleanType()))) {
         iterator I(consequentNodes.begin(), caster());
         iterator E(consequentNodes.end(), caster());
-        StmtSequence *consequents = new StmtSequence(loc, I, E);
+        StmtSequence *consequents = new (resource) StmtSequence(loc, I, E);
 
         conditionNode.release();
         consequentNodes.release();
-        return getNode(new IfStmt(loc, pred, consequents));
+        return getNode(new (resource) IfStmt(loc, pred, consequents));
     }
     return getInvalidNode();
 }
@@ -152,7 +152,7 @@ Node TypeCheck::acceptElseStmt(Location loc, Node ifNode,
 
     iterator I(alternateNodes.begin(), caster());
     iterator E(alternateNodes.end(), caster());
-    StmtSequence *alternates = new StmtSequence(loc, I, E);
+    StmtSequence *alternates = new (resource) StmtSequence(loc, I, E);
 
     cond->setAlternate(loc, alternates);
     alternateNodes.release();
@@ -171,7 +171,7 @@ Node TypeCheck::acceptElsifStmt(Location loc, Node ifNode, Node conditionNode,
     if ((pred = checkExprInContext(pred, resource.getTheBooleanType()))) {
         iterator I(consequentNodes.begin(), caster());
         iterator E(consequentNodes.end(), caster());
-        StmtSequence *consequents = new StmtSequence(loc, I, E);
+        StmtSequence *consequents = new (resource) StmtSequence(loc, I, E);
 
         cond->addElsif(loc, pred, consequents);
         conditionNode.release();
@@ -186,7 +186,7 @@ Node TypeCheck::beginBlockStmt(Location loc, IdentifierInfo *label)
 {
     // Create a new block node, establish a new declarative region and scope.
     DeclRegion *region = currentDeclarativeRegion();
-    BlockStmt  *block  = new BlockStmt(loc, region, label);
+    BlockStmt  *block  = new (resource) BlockStmt(loc, region, label);
 
     declarativeRegion = block;
     scope.push();
@@ -262,7 +262,7 @@ Node TypeCheck::beginWhileStmt(Location loc, Node conditionNode,
 
     if ((pred = checkExprInContext(pred, resource.getTheBooleanType()))) {
         conditionNode.release();
-        WhileStmt *loop = new WhileStmt(loc, pred);
+        WhileStmt *loop = new (resource) WhileStmt(loc, pred);
 
         if (tag)
             loop->setTag(tag, tagLoc);
@@ -292,7 +292,7 @@ Node TypeCheck::endWhileStmt(Node whileNode)
 Node TypeCheck::beginLoopStmt(Location loc,
                               IdentifierInfo *tag, Location tagLoc)
 {
-    LoopStmt *loop = new LoopStmt(loc);
+    LoopStmt *loop = new (resource) LoopStmt(loc);
 
     if (tag)
         loop->setTag(tag, tagLoc);
@@ -323,8 +323,8 @@ Node TypeCheck::beginForStmt(Location loc,
 {
     DSTDefinition *control = cast_node<DSTDefinition>(controlNode);
     DiscreteType *iterTy = control->getType();
-    LoopDecl *iter = new LoopDecl(iterName, iterTy, iterLoc);
-    ForStmt *loop = new ForStmt(loc, iter, control);
+    LoopDecl *iter = new (resource) LoopDecl(iterName, iterTy, iterLoc);
+    ForStmt *loop = new (resource) ForStmt(loc, iter, control);
 
     if (isReversed)
         loop->markAsReversed();
@@ -398,8 +398,11 @@ Node TypeCheck::acceptExitStmt(Location exitLoc,
             return getInvalidNode();
     }
 
-    ExitStmt *exit =
-        tag ? new ExitStmt(exitLoc, tag, tagLoc) : new ExitStmt(exitLoc);
+    ExitStmt *exit;
+    if (tag)
+        exit = new (resource) ExitStmt(exitLoc, tag, tagLoc);
+    else
+        exit = new (resource) ExitStmt(exitLoc);
     conditionNode.release();
     if (condition)
         exit->setCondition(condition);
@@ -421,7 +424,7 @@ Node TypeCheck::acceptPragmaStmt(IdentifierInfo *name, Location loc,
 
     if (pragma) {
         argNodes.release();
-        return getNode(new PragmaStmt(pragma));
+        return getNode(new (resource) PragmaStmt(pragma));
     }
     else
         return getInvalidNode();
@@ -448,7 +451,7 @@ Node TypeCheck::acceptRaiseStmt(Location raiseLoc, Node exceptionNode,
 
     exceptionNode.release();
     messageNode.release();
-    RaiseStmt *raise = new RaiseStmt(raiseLoc, ref, message);
+    RaiseStmt *raise = new (resource) RaiseStmt(raiseLoc, ref, message);
     return getNode(raise);
 }
 
@@ -476,7 +479,9 @@ Node TypeCheck::beginHandlerStmt(Location loc, NodeVector &choiceNodes)
         return getInvalidNode();
 
     choiceNodes.release();
-    HandlerStmt *handler = new HandlerStmt(loc, choices.data(), choices.size());
+    HandlerStmt *handler = new (resource) HandlerStmt(resource, loc,
+                                                      choices.data(),
+                                                      choices.size());
     return getNode(handler);
 }
 
@@ -498,5 +503,5 @@ void TypeCheck::endHandlerStmt(Node context, Node handlerNode)
 
 Node TypeCheck::acceptNullStmt(Location loc)
 {
-    return getNode(new NullStmt(loc));
+    return getNode(new (resource) NullStmt(loc));
 }
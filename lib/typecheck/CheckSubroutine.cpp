@@ -21,6 +21,7 @@
 #include "comma/ast/Stmt.h"
 #include "comma/ast/TypeRef.h"
 #include "comma/basic/PrimitiveOps.h"
+#include "comma/basic/TimeTrace.h"
 
 using namespace comma;
 using llvm::dyn_cast;
@@ -80,7 +81,8 @@ void TypeCheck::acceptSubroutineParameter(IdentifierInfo *formal, Location loc,
     }
 
     Type *paramTy = tyDecl->getType();
-    ParamValueDecl *paramDecl = new ParamValueDecl(formal, paramTy, mode, loc);
+    ParamValueDecl *paramDecl = new (resource) ParamValueDecl(formal, paramTy,
+                                                              mode, loc);
     routineStencil.addParameter(paramDecl);
 }
 
@@ -145,14 +147,14 @@ Node TypeCheck::endSubroutineDeclaration(bool definitionFollows)
     DeclRegion *region = currentDeclarativeRegion();
     if (routineStencil.denotesFunction()) {
         Type *returnType = routineStencil.getReturnType()->getType();
-        routineDecl = new FunctionDecl(resource, name, location,
-                                       params.data(), params.size(),
-                                       returnType, region);
+        routineDecl = new (resource) FunctionDecl(resource, name, location,
+                                                  params.data(), params.size(),
+                                                  returnType, region);
     }
     else
-        routineDecl = new ProcedureDecl(resource, name, location,
-                                        params.data(), params.size(),
-                                        region);
+        routineDecl = new (resource) ProcedureDecl(resource, name, location,
+                                                   params.data(), params.size(),
+                                                   region);
 
     // Ensure this new declaration does not conflict with any other currently in
     // scope.
@@ -204,6 +206,11 @@ Node TypeCheck::beginSubroutineDefinition(Node declarationNode)
     declarationNode.release();
     SubroutineDecl *srDecl = cast_node<SubroutineDecl>(declarationNode);
 
+    // The trace event is closed by endSubroutineDefinition.  Since checking
+    // is driven by the parser the event covers the parse of the body as well.
+    if (TimeTrace::isEnabled())
+        TimeTrace::begin("Check subroutine", srDecl->getString());
+
     // Enter a scope for the subroutine definition.  Add the subroutine itself
     // as an element of the new scope and add the formal parameters.  This
     // should never result in conflicts.
@@ -218,7 +225,8 @@ Node TypeCheck::beginSubroutineDefinition(Node declarationNode)
     // current declarative region.
     assert(!srDecl->hasBody() && "Current subroutine already has a body!");
 
-    BlockStmt *block = new BlockStmt(Location(), srDecl, srDecl->getIdInfo());
+    BlockStmt *block = new (resource) BlockStmt(Location(), srDecl,
+                                                srDecl->getIdInfo());
     srDecl->setBody(block);
     pushDeclarativeRegion(block);
     Node blockNode = getNode(block);
@@ -274,6 +282,9 @@ void TypeCheck::endSubroutineDefinition()
     // Pop the declarative region and scope corresponding to the current subroutine.
     popDeclarativeRegion();
     scope.pop();
+
+    if (TimeTrace::isEnabled())
+        TimeTrace::end();
 }
 
 /// Returns true if the given parameter is of mode "in", and thus capatable with
@@ -25,34 +25,69 @@
 #define COMMA_AST_HOMONYM_HDR_GUARD
 
 #include "comma/ast/AstBase.h"
-#include "llvm/ADT/PointerIntPair.h"
-#include <list>
+#include "llvm/ADT/SmallVector.h"
 
 namespace comma {
 
 class Homonym {
 
-    typedef std::list<Decl*> DeclList;
-
-    DeclList directDecls;
-    DeclList importDecls;
+    // Declarations are stored inline in order of addition, each paired with
+    // the tag of the scope entry which introduced it.  Since scopes nest, the
+    // declarations introduced by the innermost scope always occupy the tail
+    // of each vector and can be discarded without searching.
+    typedef llvm::SmallVector<Decl*, 2> DeclVector;
+    typedef llvm::SmallVector<unsigned, 2> TagVector;
+
+    DeclVector directDecls;
+    TagVector  directTags;
+    DeclVector importDecls;
+    TagVector  importTags;
+
+    static void popDecls(DeclVector &decls, TagVector &tags, unsigned tag) {
+        while (!tags.empty() && tags.back() == tag) {
+            decls.pop_back();
+            tags.pop_back();
+        }
+    }
 
 public:
     Homonym() { }
 
-    ~Homonym() { clear(); }
-
     void clear() {
         directDecls.clear();
+        directTags.clear();
         importDecls.clear();
+        importTags.clear();
+    }
+
+    // Adds a direct declaration introduced by the scope entry with the given
+    // tag.
+    void addDirectDecl(Decl *decl, unsigned tag) {
+        assert((directTags.empty() || directTags.back() <= tag) &&
+               "Declaration added to an inactive scope!");
+        directDecls.push_back(decl);
+        directTags.push_back(tag);
     }
 
-    void addDirectDecl(Decl *decl) {
-        directDecls.push_front(decl);
+    // Adds an import declaration introduced by the scope entry with the given
+    // tag.
+    void addImportDecl(Decl *decl, unsigned tag) {
+        assert((importTags.empty() || importTags.back() <= tag) &&
+               "Declaration added to an inactive scope!");
+        importDecls.push_back(decl);
+        importTags.push_back(tag);
     }
 
-    void addImportDecl(Decl *decl) {
-        importDecls.push_front(decl);
+    // Removes all direct declarations introduced by the scope entry with the
+    // given tag, which must be the innermost entry.
+    void popDirectDecls(unsigned tag) {
+        popDecls(directDecls, directTags, tag);
+    }
+
+    // Removes all import declarations introduced by the scope entry with the
+    // given tag, which must be the innermost entry.
+    void popImportDecls(unsigned tag) {
+        popDecls(importDecls, importTags, tag);
     }
 
     // Returns true if this Homonym is empty.
@@ -70,20 +105,17 @@ public:
         return !directDecls.empty();
     }
 
-    typedef DeclList::iterator DirectIterator;
-    typedef DeclList::iterator ImportIterator;
-
-    DirectIterator beginDirectDecls() { return directDecls.begin(); }
-
-    DirectIterator endDirectDecls() { return directDecls.end(); }
+    // Iterators over the declarations, most recently added first.
+    typedef DeclVector::reverse_iterator DirectIterator;
+    typedef DeclVector::reverse_iterator ImportIterator;
 
-    ImportIterator beginImportDecls() { return importDecls.begin(); }
+    DirectIterator beginDirectDecls() { return directDecls.rbegin(); }
 
-    ImportIterator endImportDecls() { return importDecls.end(); }
+    DirectIterator endDirectDecls() { return directDecls.rend(); }
 
-    void eraseDirectDecl(DirectIterator &iter) { directDecls.erase(iter); }
+    ImportIterator beginImportDecls() { return importDecls.rbegin(); }
 
-    void eraseImportDecl(ImportIterator &iter) { importDecls.erase(iter); }
+    ImportIterator endImportDecls() { return importDecls.rend(); }
 };
 
 } // End comma namespace.
@@ -0,0 +1,249 @@
+//===-- typecheck/RangeAnalysis.cpp --------------------------- -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+#include "RangeAnalysis.h"
+#include "comma/ast/Decl.h"
+#include "comma/ast/Expr.h"
+#include "comma/ast/Range.h"
+
+#include "llvm/Support/DataTypes.h"
+
+using namespace comma;
+
+using llvm::dyn_cast;
+using llvm::cast;
+using llvm::isa;
+
+namespace {
+
+/// \class
+///
+/// \brief A closed interval of 64 bit integers.
+struct Interval {
+    int64_t lower;
+    int64_t upper;
+
+    Interval() : lower(0), upper(0) { }
+
+    /// Returns true if every element of \p I is an element of this interval.
+    bool contains(const Interval &I) const {
+        return lower <= I.lower && I.upper <= upper;
+    }
+
+    /// Narrows this interval to its intersection with \p I.  An empty
+    /// intersection leaves this interval unchanged.
+    void intersect(const Interval &I) {
+        int64_t newLower = lower < I.lower ? I.lower : lower;
+        int64_t newUpper = upper > I.upper ? I.upper : upper;
+        if (newLower <= newUpper) {
+            lower = newLower;
+            upper = newUpper;
+        }
+    }
+};
+
+/// Converts \p value to an int64_t, interpreting \p value as signed or
+/// unsigned according to \p isSigned.  Returns false if the value does not
+/// fit.
+bool getInt64(const llvm::APInt &value, bool isSigned, int64_t &result)
+{
+    if (isSigned) {
+        if (value.getMinSignedBits() > 64)
+            return false;
+        result = value.getSExtValue();
+    }
+    else {
+        if (value.getActiveBits() > 63)
+            return false;
+        result = static_cast<int64_t>(value.getZExtValue());
+    }
+    return true;
+}
+
+/// Returns a 128 bit APInt holding \p value.  Products of two 64 bit values
+/// fit into this width without overflow.
+inline llvm::APInt getWide(int64_t value)
+{
+    return llvm::APInt(128, static_cast<uint64_t>(value), true);
+}
+
+/// Computes the interval given by the representational limits of \p type.
+bool getLimitBounds(const DiscreteType *type, Interval &result)
+{
+    llvm::APInt lower;
+    llvm::APInt upper;
+    bool isSigned = type->isSigned();
+
+    type->getLowerLimit(lower);
+    type->getUpperLimit(upper);
+    return (getInt64(lower, isSigned, result.lower) &&
+            getInt64(upper, isSigned, result.upper));
+}
+
+/// Computes the interval given by the bounds of \p type.  Unconstrained types
+/// are bounded by their representational limits.  Returns false if \p type
+/// is dynamically constrained or constrained to a null range.
+bool getStaticBounds(const DiscreteType *type, Interval &result)
+{
+    const Range *range = type->getConstraint();
+
+    if (!range)
+        return getLimitBounds(type, result);
+
+    if (!range->isStatic() || range->isNull())
+        return false;
+
+    bool isSigned = type->isSigned();
+    return (getInt64(range->getStaticLowerBound(), isSigned, result.lower) &&
+            getInt64(range->getStaticUpperBound(), isSigned, result.upper));
+}
+
+/// Computes an interval containing every value \p expr can take at runtime.
+/// Returns false if nothing is known about \p expr.
+bool getExprBounds(const Expr *expr, Interval &result);
+
+/// Computes an interval containing the result of applying the given signed
+/// arithmetic operation to the operands of \p call.  Returns false if the
+/// operation is not supported or may overflow.
+bool getArithmeticBounds(PO::PrimitiveID ID, const FunctionCallExpr *call,
+                         Interval &result)
+{
+    FunctionCallExpr::const_arg_iterator I = call->begin_arguments();
+    Interval x;
+    Interval y;
+
+    if (!getExprBounds(*I, x))
+        return false;
+
+    if (PO::denotesBinaryOp(ID) && !getExprBounds(*++I, y))
+        return false;
+
+    llvm::APInt lower;
+    llvm::APInt upper;
+
+    switch (ID) {
+
+    default:
+        return false;
+
+    case PO::POS_op:
+        result = x;
+        return true;
+
+    case PO::NEG_op:
+        lower = -getWide(x.upper);
+        upper = -getWide(x.lower);
+        break;
+
+    case PO::ADD_op:
+        lower = getWide(x.lower) + getWide(y.lower);
+        upper = getWide(x.upper) + getWide(y.upper);
+        break;
+
+    case PO::SUB_op:
+        lower = getWide(x.lower) - getWide(y.upper);
+        upper = getWide(x.upper) - getWide(y.lower);
+        break;
+
+    case PO::MUL_op: {
+        llvm::APInt products[4] = {
+            getWide(x.lower) * getWide(y.lower),
+            getWide(x.lower) * getWide(y.upper),
+            getWide(x.upper) * getWide(y.lower),
+            getWide(x.upper) * getWide(y.upper)
+        };
+        lower = upper = products[0];
+        for (unsigned i = 1; i < 4; ++i) {
+            if (products[i].slt(lower))
+                lower = products[i];
+            if (products[i].sgt(upper))
+                upper = products[i];
+        }
+        break;
+    }
+    }
+
+    return (getInt64(lower, true, result.lower) &&
+            getInt64(upper, true, result.upper));
+}
+
+bool getExprBounds(const Expr *expr, Interval &result)
+{
+    if (!expr->hasType())
+        return false;
+
+    const DiscreteType *type = dyn_cast<DiscreteType>(expr->getType());
+
+    // Static expressions denote a single value.  Values of type
+    // universal_integer are always interpreted as signed.
+    llvm::APInt value;
+    if (expr->staticDiscreteValue(value)) {
+        if (!getInt64(value, !type || type->isSigned(), result.lower))
+            return false;
+        result.upper = result.lower;
+        return true;
+    }
+
+    if (!type)
+        return false;
+
+    // Every value of a subtype lies within the bounds of that subtype.
+    // Dynamically constrained subtypes are known only to lie within the limits
+    // of their root type.
+    if (!getStaticBounds(type, result) && !getLimitBounds(type, result))
+        return false;
+
+    // Only signed integer values are refined structurally.  Modular
+    // arithmetic wraps.
+    if (!type->isSigned())
+        return true;
+
+    Interval refined;
+
+    if (const ConversionExpr *conv = dyn_cast<ConversionExpr>(expr)) {
+        // A conversion preserves the value of its operand.
+        if (getExprBounds(conv->getOperand(), refined))
+            result.intersect(refined);
+    }
+    else if (const FunctionCallExpr *call = dyn_cast<FunctionCallExpr>(expr)) {
+        // Primitive arithmetic is computed without overflow checks.  Refine
+        // the result only when no overflow is possible.
+        if (call->isPrimitive()) {
+            const FunctionDecl *fdecl = call->getConnective();
+            Interval limits;
+            if (getArithmeticBounds(fdecl->getPrimitiveID(), call, refined) &&
+                getLimitBounds(type, limits) && limits.contains(refined))
+                result.intersect(refined);
+        }
+    }
+
+    return true;
+}
+
+} // end anonymous namespace.
+
+bool RangeAnalysis::annotateConversion(ConversionExpr *expr)
+{
+    DiscreteType *target = dyn_cast<DiscreteType>(expr->getType());
+
+    // Conversions to modular types never raise.
+    if (!target || (isa<IntegerType>(target) && !target->isSigned()))
+        return false;
+
+    Interval bounds;
+    Interval operand;
+    if (!getStaticBounds(target, bounds) ||
+        !getExprBounds(expr->getOperand(), operand))
+        return false;
+
+    if (!bounds.contains(operand))
+        return false;
+
+    expr->markAsStaticallyInRange();
+    return true;
+}
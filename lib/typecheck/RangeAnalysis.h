@@ -0,0 +1,56 @@
+//===-- typecheck/RangeAnalysis.h ----------------------------- -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef COMMA_TYPECHECK_RANGEANALYSIS_HDR_GUARD
+#define COMMA_TYPECHECK_RANGEANALYSIS_HDR_GUARD
+
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// \brief Defines the RangeAnalysis class.
+//===----------------------------------------------------------------------===//
+
+namespace comma {
+
+class ConversionExpr;
+
+//===----------------------------------------------------------------------===//
+// RangeAnalysis
+//
+/// \class
+///
+/// \brief RangeAnalysis proves the range checks of discrete conversions
+/// redundant.
+///
+/// Every discrete expression is assigned an interval of possible values.  The
+/// interval is computed from static values, the bounds of the expression's
+/// subtype, the targets of nested conversions and the primitive arithmetic
+/// operators over signed integer types.  Since a loop parameter or the target
+/// of an assignment is of a constrained subtype, references to such entities
+/// are bounded by that subtype.
+///
+/// The analysis is flow insensitive.  It relies on the invariant that a value
+/// of a given subtype lies within the bounds of that subtype, which is the
+/// same invariant code generation assumes when omitting checks between
+/// subtypes known to contain one another.
+class RangeAnalysis {
+
+public:
+    /// \brief Analyzes the given conversion.
+    ///
+    /// If the operand of \p expr is known to lie within the bounds of the
+    /// target type, \p expr is marked as statically in range and true is
+    /// returned.  Otherwise \p expr is left unchanged and false is returned.
+    ///
+    /// The operand of \p expr must have been fully resolved.
+    static bool annotateConversion(ConversionExpr *expr);
+};
+
+} // end comma namespace.
+
+#endif
@@ -85,18 +85,21 @@ DiscreteType *RangeChecker::checkDSTRange(Expr *lower, Expr *upper)
         }
     }
 
+    AstResource &resource = TC.getAstResource();
     DiscreteType *rangeTy = cast<DiscreteType>(lower->getType());
 
     // If the type of range is root_integer, replace the lower and upper bounds
     // with conversion expressions to Integer.
-    if (rangeTy == TC.getAstResource().getTheRootIntegerType()) {
-        rangeTy = TC.getAstResource().getTheIntegerType();
-        lower = new ConversionExpr(lower, rangeTy, lower->getLocation(), true);
-        upper = new ConversionExpr(upper, rangeTy, upper->getLocation(), true);
+    if (rangeTy == resource.getTheRootIntegerType()) {
+        rangeTy = resource.getTheIntegerType();
+        lower = new (resource) ConversionExpr(lower, rangeTy,
+                                              lower->getLocation(), true);
+        upper = new (resource) ConversionExpr(upper, rangeTy,
+                                              upper->getLocation(), true);
     }
 
     // Form a constrained discrete subtype constrained by the given bounds.
-    rangeTy = TC.getAstResource().createDiscreteSubtype(rangeTy, lower, upper);
+    rangeTy = resource.createDiscreteSubtype(rangeTy, lower, upper);
 
     return rangeTy;
 }
@@ -48,66 +48,81 @@ void Scope::Entry::addDirectDecl(Decl *decl)
     if (directDecls.insert(decl)) {
         IdentifierInfo *idInfo  = decl->getIdInfo();
         Homonym        *homonym = getOrCreateHomonym(idInfo);
-        homonym->addDirectDecl(decl);
+        homonym->addDirectDecl(decl, tag);
     }
 }
 
-void Scope::Entry::removeDirectDecl(Decl *decl)
+bool Scope::Entry::containsDirectDecl(IdentifierInfo *name)
 {
-    assert(containsDirectDecl(decl) &&
-           "Declaration not associated with this scope entry!");
-
-    IdentifierInfo *info    = decl->getIdInfo();
-    Homonym        *homonym = info->getMetadata<Homonym>();
-    assert(homonym && "No identifier metadata!");
-
-    for (Homonym::DirectIterator iter = homonym->beginDirectDecls();
-         iter != homonym->endDirectDecls(); ++iter)
-        if (decl == *iter) {
-            homonym->eraseDirectDecl(iter);
-            return;
-        }
-    assert(false && "Decl not associated with corresponding identifier!");
+    DirectIterator endIter = endDirectDecls();
+    for (DirectIterator iter = beginDirectDecls(); iter != endIter; ++iter)
+        if (name == (*iter)->getIdInfo()) return true;
+    return false;
 }
 
-void Scope::Entry::removeImportDecl(Decl *decl)
+void Scope::Entry::addImport(PkgInstanceDecl *package,
+                             const ImportSet *imports)
 {
-    IdentifierInfo *info    = decl->getIdInfo();
-    Homonym        *homonym = info->getMetadata<Homonym>();
-    assert(homonym && "No identifier metadata!");
-
-    for (Homonym::ImportIterator iter = homonym->beginImportDecls();
-         iter != homonym->endImportDecls(); ++iter)
-        if (decl == *iter) {
-            homonym->eraseImportDecl(iter);
-            return;
-        }
-    assert(false && "Decl not associated with corresponding indentifier!");
+    imports->apply(tag);
+    importDecls.push_back(package);
+    importSets.push_back(imports);
 }
 
-bool Scope::Entry::containsDirectDecl(IdentifierInfo *name)
+// Turns this into an uninitialized (dead) scope entry.  This method is
+// used so that entries can be cached and recognized as inactive objects.
+void Scope::Entry::clear()
 {
-    DirectIterator endIter = endDirectDecls();
-    for (DirectIterator iter = beginDirectDecls(); iter != endIter; ++iter)
-        if (name == (*iter)->getIdInfo()) return true;
-    return false;
+    // Traverse the set of IdentifierInfo's owned by this entry and reduce the
+    // associated decl stacks.  The declarations introduced by this entry are
+    // always the most recent of each homonym, so each is discarded in
+    // constant time.
+    DirectIterator endDeclIter = endDirectDecls();
+    for (DirectIterator declIter = beginDirectDecls();
+         declIter != endDeclIter; ++declIter) {
+        IdentifierInfo *info    = (*declIter)->getIdInfo();
+        Homonym        *homonym = info->getMetadata<Homonym>();
+        assert(homonym && "No identifier metadata!");
+        homonym->popDirectDecls(tag);
+    }
+
+    for (unsigned i = 0; i < importSets.size(); ++i)
+        importSets[i]->retract(tag);
+
+    kind = DEAD_SCOPE;
+    directDecls.clear();
+    importDecls.clear();
+    importSets.clear();
 }
 
-void Scope::Entry::importDeclarativeRegion(DeclRegion *region)
+//===----------------------------------------------------------------------===//
+// Scope::ImportSet methods.
+
+Scope::ImportSet::ImportSet(PkgInstanceDecl *package)
+    : package(package)
+{
+    // A use clause makes every declaration of the package visible.
+    package->materializeAll();
+    numDecls = package->countDecls();
+
+    llvm::SmallPtrSet<Homonym*, 32> seen;
+    collectBindings(package, seen);
+}
+
+void Scope::ImportSet::collectBindings(DeclRegion *region,
+                                       llvm::SmallPtrSet<Homonym*, 32> &seen)
 {
     typedef DeclRegion::DeclIter DeclIter;
 
-    DeclIter iter;
     DeclIter endIter = region->endDecls();
-    for (iter = region->beginDecls(); iter != endIter; ++iter) {
-        Decl           *decl    = *iter;
-        IdentifierInfo *idinfo  = decl->getIdInfo();
-        Homonym        *homonym = getOrCreateHomonym(idinfo);
+    for (DeclIter iter = region->beginDecls(); iter != endIter; ++iter) {
+        Decl    *decl    = *iter;
+        Homonym *homonym = getOrCreateHomonym(decl->getIdInfo());
 
-        homonym->addImportDecl(decl);
+        bindings.push_back(Binding(homonym, decl));
+        if (seen.insert(homonym))
+            homonyms.push_back(homonym);
 
-        switch (decl->getKind())
-        {
+        switch (decl->getKind()) {
         default:
             break;
 
@@ -115,65 +130,24 @@ void Scope::Entry::importDeclarativeRegion(DeclRegion *region)
         case Ast::AST_EnumerationDecl:
         case Ast::AST_IntegerDecl:
         case Ast::AST_PrivateTypeDecl:
-            importDeclarativeRegion(cast<DeclRegion>(decl));
+            collectBindings(cast<DeclRegion>(decl), seen);
             break;
         }
     }
 }
 
-void Scope::Entry::clearDeclarativeRegion(DeclRegion *region)
+void Scope::ImportSet::apply(unsigned tag) const
 {
-    typedef DeclRegion::DeclIter DeclIter;
-
-    DeclIter iter;
-    DeclIter endIter = region->endDecls();
-    for (iter = region->beginDecls(); iter != endIter; ++iter) {
-        Decl *decl = *iter;
-        removeImportDecl(decl);
-        // Clear the contents of enumeration and integer decls.
-        if (EnumerationDecl *edecl = dyn_cast<EnumerationDecl>(decl))
-            clearDeclarativeRegion(edecl);
-        else if (IntegerDecl *idecl = dyn_cast<IntegerDecl>(decl))
-            clearDeclarativeRegion(idecl);
-    }
+    typedef BindingVector::const_iterator iterator;
+    for (iterator I = bindings.begin(); I != bindings.end(); ++I)
+        I->first->addImportDecl(I->second, tag);
 }
 
-void Scope::Entry::addImport(PkgInstanceDecl *package)
+void Scope::ImportSet::retract(unsigned tag) const
 {
-    importDeclarativeRegion(package);
-    importDecls.push_back(package);
-}
-
-// Turns this into an uninitialized (dead) scope entry.  This method is
-// used so that entries can be cached and recognized as inactive objects.
-void Scope::Entry::clear()
-{
-    // Traverse the set of IdentifierInfo's owned by this entry and reduce the
-    // associated decl stacks.
-    DirectIterator endDeclIter = endDirectDecls();
-    for (DirectIterator declIter = beginDirectDecls();
-         declIter != endDeclIter; ++declIter)
-        removeDirectDecl(*declIter);
-
-    ImportIterator endImportIter = endImportDecls();
-    for (ImportIterator importIter = beginImportDecls();
-         importIter != endImportIter; ++importIter)
-        clearDeclarativeRegion(*importIter);
-
-    kind = DEAD_SCOPE;
-    directDecls.clear();
-    importDecls.clear();
-}
-
-Homonym *Scope::Entry::getOrCreateHomonym(IdentifierInfo *info)
-{
-    Homonym *homonym = info->getMetadata<Homonym>();
-
-    if (!homonym) {
-        homonym = new Homonym();
-        info->setMetadata(homonym);
-    }
-    return homonym;
+    typedef HomonymVector::const_iterator iterator;
+    for (iterator I = homonyms.begin(); I != homonyms.end(); ++I)
+        (*I)->popImportDecls(tag);
 }
 
 //===----------------------------------------------------------------------===//
@@ -188,6 +162,10 @@ Scope::Scope()
 Scope::~Scope()
 {
     while (!entries.empty()) pop();
+
+    for (ImportSetMap::iterator I = importSets.begin();
+         I != importSets.end(); ++I)
+        delete I->second;
 }
 
 ScopeKind Scope::getKind() const
@@ -235,11 +213,36 @@ bool Scope::addImport(PkgInstanceDecl *package)
     }
 
     // The import is not yet in scope.  Register it with the current entry.
-    entries.front()->addImport(package);
+    entries.front()->addImport(package, getImportSet(package));
 
     return false;
 }
 
+const Scope::ImportSet *Scope::getImportSet(PkgInstanceDecl *package)
+{
+    // Reuse the bindings computed for a previous import of the package unless
+    // declarations have since been added to it.
+    ImportSet *&imports = importSets[package];
+    if (imports && !imports->isCurrent()) {
+        delete imports;
+        imports = 0;
+    }
+    if (!imports)
+        imports = new ImportSet(package);
+    return imports;
+}
+
+Homonym *Scope::getOrCreateHomonym(IdentifierInfo *info)
+{
+    Homonym *homonym = info->getMetadata<Homonym>();
+
+    if (!homonym) {
+        homonym = new Homonym();
+        info->setMetadata(homonym);
+    }
+    return homonym;
+}
+
 Decl *Scope::addDirectDecl(Decl *decl)
 {
     if (Decl *conflict = findConflictingDirectDecl(decl))
@@ -13,9 +13,11 @@
 #include "comma/ast/AstBase.h"
 #include "comma/ast/Decl.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
 #include <deque>
+#include <vector>
 
 namespace comma {
 
@@ -82,6 +84,42 @@ public:
     void dump() const;
 
 private:
+    // The homonym insertions performed when a package is imported.  Import
+    // sets are computed on the first import of each package and cached by the
+    // Scope, so that later imports of the same package are applied and
+    // retracted in bulk without traversing its declarative region.
+    class ImportSet {
+
+    public:
+        ImportSet(PkgInstanceDecl *package);
+
+        // Returns true if the package has not gained declarations since this
+        // set was computed.
+        bool isCurrent() const { return numDecls == package->countDecls(); }
+
+        // Adds each binding to its homonym on behalf of the scope entry with
+        // the given tag.
+        void apply(unsigned tag) const;
+
+        // Removes the bindings added by a call to apply with the given tag.
+        void retract(unsigned tag) const;
+
+    private:
+        PkgInstanceDecl *package;
+        unsigned numDecls;
+
+        typedef std::pair<Homonym*, Decl*> Binding;
+        typedef std::vector<Binding> BindingVector;
+        BindingVector bindings;
+
+        // The distinct homonyms referenced by the bindings.
+        typedef std::vector<Homonym*> HomonymVector;
+        HomonymVector homonyms;
+
+        void collectBindings(DeclRegion *region,
+                             llvm::SmallPtrSet<Homonym*, 32> &seen);
+    };
+
     // An entry in a Scope object.
     class Entry {
 
@@ -109,10 +147,6 @@ private:
 
         void addDirectDecl(Decl *decl);
 
-        void removeDirectDecl(Decl *decl);
-
-        void removeImportDecl(Decl *decl);
-
         // Returns the number of direct declarations managed by this entry.
         unsigned numDirectDecls() const { return directDecls.size(); }
 
@@ -126,7 +160,7 @@ private:
             return directDecls.count(decl);
         }
 
-        void addImport(PkgInstanceDecl *package);
+        void addImport(PkgInstanceDecl *package, const ImportSet *imports);
 
         // Returns the number of imported declarations managed by this frame.
         unsigned numImportDecls() const { return importDecls.size(); }
@@ -155,10 +189,8 @@ private:
         DeclSet      directDecls;
         ImportVector importDecls;
 
-        static Homonym *getOrCreateHomonym(IdentifierInfo *info);
-
-        void importDeclarativeRegion(DeclRegion *region);
-        void clearDeclarativeRegion(DeclRegion *region);
+        // The import sets applied by this entry, parallel to importDecls.
+        llvm::SmallVector<const ImportSet*, 8> importSets;
     };
 
     // Type of stack used to maintain our scope frames.
@@ -176,6 +208,15 @@ private:
     // Number of entries currently cached and available for reuse.
     unsigned numCachedEntries;
 
+    // Import sets computed for each package imported thus far.
+    typedef llvm::DenseMap<PkgInstanceDecl*, ImportSet*> ImportSetMap;
+    ImportSetMap importSets;
+
+    // Returns the import set for the given package, computing it if needed.
+    const ImportSet *getImportSet(PkgInstanceDecl *package);
+
+    static Homonym *getOrCreateHomonym(IdentifierInfo *info);
+
     // If the given declaration conflicts with another declaration in the
     // current entry, return the declaration with which it conflicts.
     // Otherwise, return null.
@@ -6,6 +6,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "RangeAnalysis.h"
 #include "RangeChecker.h"
 #include "Scope.h"
 #include "Stencil.h"
@@ -316,8 +317,10 @@ ArrayType *TypeCheck::getConstrainedArraySubtype(ArrayType *arrTy, Expr *init)
         // FIXME: Support enumeration types by generating Val attribute
         // expressions.
         IntegerType *intTy = cast<IntegerType>(idxTy);
-        Expr *lowerExpr = new IntegerLiteral(lower, intTy, Location());
-        Expr *upperExpr = new IntegerLiteral(upper, intTy, Location());
+        Expr *lowerExpr = new (resource) IntegerLiteral(lower, intTy,
+                                                        Location());
+        Expr *upperExpr = new (resource) IntegerLiteral(upper, intTy,
+                                                        Location());
         idxTy = resource.createIntegerSubtype(intTy, lowerExpr, upperExpr);
         return resource.createArraySubtype(0, arrTy, &idxTy);
     }
@@ -355,7 +358,7 @@ ObjectDecl *TypeCheck::acceptArrayObjectDeclaration(Location loc,
     if (!arrTy->isConstrained())
         arrTy = cast<ArrayType>(init->getType());
 
-    return new ObjectDecl(name, arrTy, loc, init);
+    return new (resource) ObjectDecl(name, arrTy, loc, init);
 }
 
 bool TypeCheck::acceptObjectDeclaration(Location loc, IdentifierInfo *name,
@@ -385,7 +388,7 @@ bool TypeCheck::acceptObjectDeclaration(Location loc, IdentifierInfo *name,
                 return false;
             }
         }
-        decl = new ObjectDecl(name, STIType, loc, init);
+        decl = new (resource) ObjectDecl(name, STIType, loc, init);
     }
 
     if (decl == 0)
@@ -415,7 +418,7 @@ bool TypeCheck::acceptRenamedObjectDeclaration(Location loc,
 
     RenamedObjectDecl *decl;
     targetNode.release();
-    decl = new RenamedObjectDecl(name, STI->getType(), loc, target);
+    decl = new (resource) RenamedObjectDecl(name, STI->getType(), loc, target);
 
     if (Decl *conflict = scope.addDirectDecl(decl)) {
         SourceLocation sloc = getSourceLoc(conflict->getLocation());
@@ -436,7 +439,7 @@ bool TypeCheck::acceptUseDeclaration(Node usedNode)
         scope.addImport(package);
 
         // FIXME: Stitch this use clause into the current context.
-        new UseDecl(package, loc);
+        new (resource) UseDecl(package, loc);
         return true;
     }
 
@@ -773,7 +776,8 @@ void TypeCheck::acceptRecordComponent(IdentifierInfo *name, Location loc,
     }
 
     typeNode.release();
-    ComponentDecl *component = record->addComponent(name, loc, componentTy);
+    ComponentDecl *component;
+    component = record->addComponent(resource, name, loc, componentTy);
     if (Decl *conflict = scope.addDirectDecl(component)) {
         SourceLocation sloc = getSourceLoc(conflict->getLocation());
         report(loc, diag::DECLARATION_CONFLICTS) << name << sloc;
@@ -829,7 +833,7 @@ void TypeCheck::acceptPrivateTypeDecl(IdentifierInfo *name, Location loc,
     tags |= (typeTag & TaggedTypeTag) ? PrivateTypeDecl::Tagged : 0;
 
     PrivateTypeDecl *decl =
-        new PrivateTypeDecl(resource, name, loc, tags, region);
+        new (resource) PrivateTypeDecl(resource, name, loc, tags, region);
 
     if (introduceTypeDeclaration(decl)) {
         decl->generateImplicitDeclarations(resource);
@@ -865,7 +869,8 @@ Node TypeCheck::acceptDSTDefinition(Node name, Node lowerNode, Node upperNode)
         return getInvalidNode();
 
     DSTDefinition::DSTTag tag = DSTDefinition::Constrained_DST;
-    DSTDefinition *result = new DSTDefinition(ref->getLocation(), subtype, tag);
+    DSTDefinition *result = new (resource) DSTDefinition(ref->getLocation(),
+                                                         subtype, tag);
 
     lowerNode.release();
     upperNode.release();
@@ -881,13 +886,15 @@ Node TypeCheck::acceptDSTDefinition(Node nameOrAttribute, bool isUnconstrained)
         if (DiscreteType *type = dyn_cast<DiscreteType>(decl->getType())) {
             DSTDefinition::DSTTag tag = isUnconstrained ?
                 DSTDefinition::Unconstrained_DST : DSTDefinition::Type_DST;
-            result = new DSTDefinition(ref->getLocation(), type, tag);
+            result = new (resource) DSTDefinition(ref->getLocation(),
+                                                  type, tag);
             delete ref;
         }
     }
     else if (RangeAttrib *attrib = lift_node<RangeAttrib>(nameOrAttribute)) {
         DSTDefinition::DSTTag tag = DSTDefinition::Attribute_DST;
-        result = new DSTDefinition(attrib->getLocation(), attrib, tag);
+        result = new (resource) DSTDefinition(attrib->getLocation(), attrib,
+                                              tag);
     }
 
     if (!result) {
@@ -916,7 +923,8 @@ Node TypeCheck::acceptDSTDefinition(Node lowerNode, Node upperNode)
     lowerNode.release();
     upperNode.release();
     DSTDefinition::DSTTag tag = DSTDefinition::Range_DST;
-    return getNode(new DSTDefinition(lower->getLocation(), subtype, tag));
+    return getNode(new (resource) DSTDefinition(lower->getLocation(), subtype,
+                                                tag));
 }
 
 //===----------------------------------------------------------------------===//
@@ -936,7 +944,8 @@ Node TypeCheck::acceptSubtypeIndication(Node prefix)
         return getInvalidNode();
 
     // Do not release the prefix as we are done with the TypeRef.
-    return getNode(new STIndication(ref->getLocation(), decl->getType()));
+    return getNode(new (resource) STIndication(ref->getLocation(),
+                                               decl->getType()));
 }
 
 Node TypeCheck::acceptSubtypeIndication(Node prefix,
@@ -966,7 +975,7 @@ Node TypeCheck::acceptSubtypeIndication(Node prefix,
 
     lowerNode.release();
     upperNode.release();
-    return getNode(new STIndication(ref->getLocation(), subtype));
+    return getNode(new (resource) STIndication(ref->getLocation(), subtype));
 }
 
 Node TypeCheck::acceptSubtypeIndication(Node prefix, NodeVector &arguments)
@@ -1063,7 +1072,7 @@ Node TypeCheck::acceptSubtypeIndication(Node prefix, NodeVector &arguments)
     // store the DSTDefinition or the prefix TypeRef, do not release them.
     ArrayType *base = decl->getType();
     ArrayType *type = resource.createArraySubtype(base, &indexTypes[0]);
-    STIndication *STI = new STIndication(ref->getLocation(), type);
+    STIndication *STI = new (resource) STIndication(ref->getLocation(), type);
     return getNode(STI);
 }
 
@@ -1229,8 +1238,12 @@ bool TypeCheck::conversionRequired(Type *sourceTy, Type *targetTy)
 
 Expr *TypeCheck::convertIfNeeded(Expr *expr, Type *target)
 {
-    if (conversionRequired(expr->getType(), target))
-        return new ConversionExpr(expr, target, expr->getLocation(), true);
+    if (conversionRequired(expr->getType(), target)) {
+        ConversionExpr *conv = new (resource) ConversionExpr(
+            expr, target, expr->getLocation(), true);
+        RangeAnalysis::annotateConversion(conv);
+        return conv;
+    }
     return expr;
 }
 
@@ -1258,7 +1271,7 @@ Expr *TypeCheck::implicitlyDereference(Expr *expr, Type *target)
 {
     Type *source = resolveType(expr);
     while (isa<AccessType>(source)) {
-        expr = new DereferenceExpr(expr, expr->getLocation(), true);
+        expr = new (resource) DereferenceExpr(expr, expr->getLocation(), true);
         source = resolveType(expr);
         if (covers(source, target))
             return expr;
@@ -1271,7 +1284,7 @@ Expr *TypeCheck::implicitlyDereference(Expr *expr, Type::Classification ID)
 {
     Type *source = resolveType(expr);
     while (isa<AccessType>(source)) {
-        expr = new DereferenceExpr(expr, expr->getLocation(), true);
+        expr = new (resource) DereferenceExpr(expr, expr->getLocation(), true);
         source = resolveType(expr);
         if (source->memberOf(ID))
             return expr;
@@ -607,15 +607,11 @@ private:
                                   SVImpl<Expr*>::Type &posArgs,
                                   SVImpl<KeywordSelector*>::Type &keyArgs);
 
-    /// Checks that the given subroutine decl accepts the provided positional
-    /// arguments.
-    bool routineAcceptsArgs(SubroutineDecl *decl,
-                            SVImpl<Expr*>::Type &args);
-
-    /// Checks that the given subroutine decl accepts the provided keyword
-    /// arguments.
-    bool routineAcceptsArgs(SubroutineDecl *decl,
-                            SVImpl<KeywordSelector*>::Type &args);
+    /// Removes from \p ref each declaration which cannot accept \p arg as
+    /// the parameter at the given index, or as the parameter named by \p key
+    /// when it is non-null.  All keywords must be known to the declarations.
+    void filterByApplicableArgument(SubroutineRef *ref, Expr *arg,
+                                    unsigned index, IdentifierInfo *key);
 
     /// Checks a possibly ambiguous (overloaded) SubroutineRef \p ref given a
     /// set of positional and keyed arguments.
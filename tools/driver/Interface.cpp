@@ -0,0 +1,223 @@
+//===-- driver/Interface.cpp ---------------------------------- -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+#include "Interface.h"
+#include "SourceManager.h"
+#include "comma/parser/SpecParser.h"
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+using namespace comma;
+using namespace comma::driver;
+
+namespace {
+
+/// Version tag introducing the trailer of every interface file.  Bump this
+/// value whenever the format or the semantics of the interface change.
+const char *InterfaceTag = "-- comma interface 2";
+
+std::string formatHash(uint64_t hash)
+{
+    char buff[17];
+    std::sprintf(buff, "%016llx", static_cast<unsigned long long>(hash));
+    return buff;
+}
+
+bool parseHash(llvm::StringRef rep, uint64_t &hash)
+{
+    if (rep.size() != 16)
+        return false;
+
+    std::string str(rep.begin(), rep.end());
+    char *end;
+    hash = std::strtoull(str.c_str(), &end, 16);
+    return *end == 0;
+}
+
+} // end anonymous namespace.
+
+uint64_t comma::driver::hashText(llvm::StringRef text, uint64_t seed)
+{
+    uint64_t hash = seed;
+    for (llvm::StringRef::iterator I = text.begin(); I != text.end(); ++I) {
+        hash ^= static_cast<unsigned char>(*I);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void InterfaceFile::extract(TextProvider &provider, IdentifierPool &idPool,
+                            Diagnostic &diag)
+{
+    SpecParser parser(provider, idPool, diag);
+    SpecParser::SpecRangeVector ranges;
+
+    if (!parser.parseSpecification(ranges) || parser.hasBodyPragmas()) {
+        text = provider.getText(provider.begin(), provider.end()).str();
+        if (text.empty() || text[text.size() - 1] != '\n')
+            text.push_back('\n');
+        return;
+    }
+
+    // Reproduce each range at its original line (and, when the range starts a
+    // line of its own, its original column) so that locations reported against
+    // the interface agree with those of the source.
+    unsigned line = 1;
+    text.clear();
+    typedef SpecParser::SpecRangeVector::iterator iterator;
+    for (iterator I = ranges.begin(); I != ranges.end(); ++I) {
+        unsigned startLine = provider.getLine(I->first);
+        if (startLine > line || I == ranges.begin()) {
+            text.append(startLine - line, '\n');
+            text.append(provider.getColumn(I->first), ' ');
+        }
+        else
+            text.push_back(' ');
+        llvm::StringRef range = provider.getText(I->first, I->second);
+        text.append(range.begin(), range.end());
+        line = provider.getLine(I->second);
+    }
+    text.push_back('\n');
+}
+
+void InterfaceFile::stamp(const SourceItem *Item)
+{
+    sourceHash = Item->getSourceHash();
+    interfaceHash = hashText(text);
+    dependencies.clear();
+
+    typedef SourceItem::const_iterator iterator;
+    for (iterator I = Item->begin(); I != Item->end(); ++I) {
+        const SourceItem *Dep = *I;
+        std::string name = Dep->getCanonicalName();
+        uint64_t depHash = Dep->getInterfaceHash();
+        dependencies.push_back(DepEntry(name, depHash));
+        interfaceHash = hashText(formatHash(depHash), interfaceHash);
+    }
+}
+
+bool InterfaceFile::isCurrent(const SourceItem *Item) const
+{
+    if (sourceHash != Item->getSourceHash())
+        return false;
+
+    if (dependencies.size() != Item->numDependents())
+        return false;
+
+    unsigned index = 0;
+    typedef SourceItem::const_iterator iterator;
+    for (iterator I = Item->begin(); I != Item->end(); ++I, ++index) {
+        const SourceItem *Dep = *I;
+        const DepEntry &entry = dependencies[index];
+        if (entry.first != Dep->getCanonicalName() ||
+            entry.second != Dep->getInterfaceHash())
+            return false;
+    }
+    return true;
+}
+
+bool InterfaceFile::readTrailer(const llvm::sys::Path &path)
+{
+    std::auto_ptr<llvm::MemoryBuffer> buffer(
+        llvm::MemoryBuffer::getFile(path.c_str()));
+
+    if (!buffer.get())
+        return false;
+
+    llvm::StringRef contents(buffer->getBufferStart(), buffer->getBufferSize());
+    llvm::StringRef tag(InterfaceTag);
+
+    // Locate the final occurrence of the tag line.  Everything following it
+    // is trailer.
+    size_t tagPos = llvm::StringRef::npos;
+    size_t pos = contents.find(tag);
+    while (pos != llvm::StringRef::npos) {
+        tagPos = pos;
+        pos = contents.find(tag, pos + 1);
+    }
+    if (tagPos == llvm::StringRef::npos)
+        return false;
+
+    std::pair<llvm::StringRef, llvm::StringRef> split;
+    bool seenSource = false;
+    bool seenInterface = false;
+
+    split = contents.substr(tagPos).split('\n');
+    if (split.first != tag)
+        return false;
+
+    dependencies.clear();
+    entryPoint.clear();
+    for (;;) {
+        split = split.second.split('\n');
+        llvm::StringRef line = split.first;
+
+        if (line == "-- end")
+            break;
+
+        if (!line.startswith("-- ") || split.second.empty())
+            return false;
+
+        // Each trailer line is of the form "-- <key> <value...>".
+        std::pair<llvm::StringRef, llvm::StringRef> entry =
+            line.substr(3).split(' ');
+        llvm::StringRef key = entry.first;
+
+        if (key == "source")
+            seenSource = parseHash(entry.second, sourceHash);
+        else if (key == "interface")
+            seenInterface = parseHash(entry.second, interfaceHash);
+        else if (key == "entry")
+            entryPoint = entry.second.str();
+        else if (key == "depend") {
+            std::pair<llvm::StringRef, llvm::StringRef> dep =
+                entry.second.split(' ');
+            uint64_t depHash;
+            if (!parseHash(dep.second, depHash))
+                return false;
+            dependencies.push_back(DepEntry(dep.first.str(), depHash));
+        }
+        else
+            return false;
+    }
+
+    return seenSource && seenInterface;
+}
+
+bool InterfaceFile::write(const llvm::sys::Path &path) const
+{
+    std::string message;
+    llvm::raw_fd_ostream output(path.c_str(), message, 0);
+    if (!message.empty()) {
+        llvm::errs() << "Could not write interface file: " << message << '\n';
+        return false;
+    }
+
+    // The interface text comes first so that its line numbering matches the
+    // original source.
+    output << text;
+    output << InterfaceTag << '\n';
+    output << "-- source " << formatHash(sourceHash) << '\n';
+    output << "-- interface " << formatHash(interfaceHash) << '\n';
+
+    if (!entryPoint.empty())
+        output << "-- entry " << entryPoint << '\n';
+
+    typedef DepVector::const_iterator iterator;
+    for (iterator I = dependencies.begin(); I != dependencies.end(); ++I)
+        output << "-- depend " << I->first << ' '
+               << formatHash(I->second) << '\n';
+
+    output << "-- end\n";
+    return true;
+}
@@ -0,0 +1,114 @@
+//===-- driver/Interface.h ------------------------------------ -*- C++ -*-===//
+//
+// This file is distributed under the MIT license. See LICENSE.txt for details.
+//
+// Copyright (C) 2010, Stephen Wilson
+//
+//===----------------------------------------------------------------------===//
+
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// \brief Compiled interface files.
+///
+/// An interface file captures the public view of a SourceItem: its context
+/// clauses together with the specification of each package it declares.  The
+/// text is itself valid Comma source, followed by a trailer of comment lines
+/// recording the hash of the original source and of each dependency's
+/// interface.  The file thereby serves as the build manifest of the item.
+/// When the hashes still match, the driver parses the interface in place of
+/// the full source, skipping all package bodies and the associated code
+/// generation, or skips the item entirely when no client needs compiling.
+//===----------------------------------------------------------------------===//
+
+#ifndef COMMA_DRIVER_INTERFACE_HDR_GUARD
+#define COMMA_DRIVER_INTERFACE_HDR_GUARD
+
+#include "comma/basic/Diagnostic.h"
+#include "comma/basic/IdentifierPool.h"
+#include "comma/basic/TextProvider.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/System/Path.h"
+
+#include <string>
+#include <vector>
+
+namespace comma {
+namespace driver {
+
+class SourceItem;
+
+/// Computes a 64 bit FNV-1a hash over the given text.  A previous hash may be
+/// supplied as \p seed to combine several pieces of text into one value.
+uint64_t hashText(llvm::StringRef text,
+                  uint64_t seed = 14695981039346656037ULL);
+
+/// \class
+/// \brief Reads and writes compiled interface files.
+class InterfaceFile {
+
+public:
+    InterfaceFile() : sourceHash(0), interfaceHash(0) { }
+
+    /// Extracts the interface of the given TextProvider, which must be open
+    /// and contain source previously accepted by the type checker.
+    ///
+    /// If the public view cannot be separated from the package bodies (for
+    /// example, when a body completes a declaration with pragma Import) the
+    /// complete source is used as the interface.
+    void extract(TextProvider &provider, IdentifierPool &idPool,
+                 Diagnostic &diag);
+
+    /// Reads the trailer of the interface file at the given path.  Returns
+    /// false if the file does not exist or is malformed.
+    bool readTrailer(const llvm::sys::Path &path);
+
+    /// Writes this interface to the given path.  Returns false and emits a
+    /// message to stderr if the file could not be written.
+    bool write(const llvm::sys::Path &path) const;
+
+    /// Returns true if this interface was produced from the current contents
+    /// of the given item and the current interfaces of its dependencies.
+    bool isCurrent(const SourceItem *Item) const;
+
+    /// Records the hashes of the source and dependencies of the given item.
+    /// This method must be called after a successful call to extract.
+    void stamp(const SourceItem *Item);
+
+    /// Returns the hash of the source this interface was produced from.
+    uint64_t getSourceHash() const { return sourceHash; }
+
+    //@{
+    /// The entry point emitted into the code accompanying this interface, or
+    /// the empty string if no entry point was emitted.
+    const std::string &getEntryPoint() const { return entryPoint; }
+    void setEntryPoint(const std::string &entry) { entryPoint = entry; }
+    //@}
+
+    /// Returns the hash identifying this interface.
+    ///
+    /// The hash covers the interface text and the interface hashes of all
+    /// dependencies.  Clients need to be recompiled only when this value
+    /// changes.
+    uint64_t getInterfaceHash() const { return interfaceHash; }
+
+private:
+    uint64_t sourceHash;
+    uint64_t interfaceHash;
+    std::string entryPoint;
+
+    /// Canonical dependency names paired with their interface hash.
+    typedef std::pair<std::string, uint64_t> DepEntry;
+    typedef std::vector<DepEntry> DepVector;
+    DepVector dependencies;
+
+    /// The interface text proper.  Empty unless populated by extract.
+    std::string text;
+};
+
+} // end namespace driver
+} // end namespace comma
+
+#endif
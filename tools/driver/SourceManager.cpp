@@ -6,15 +6,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "Interface.h"
 #include "SourceManager.h"
+#include "comma/ast/Cunit.h"
 #include "comma/parser/DepParser.h"
 
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <set>
 
 using namespace comma::driver;
 
@@ -22,6 +27,11 @@ SourceManager::SourceManager(IdentifierPool &IdPool,
                              Diagnostic &Diag)
     : IdPool(IdPool),
       Diag(Diag)
+{
+    scanDirectory();
+}
+
+void SourceManager::scanDirectory()
 {
     // Get the contents of the current working directory.
     //
@@ -49,6 +59,67 @@ SourceManager::SourceManager(IdentifierPool &IdPool,
     }
 }
 
+unsigned
+SourceManager::invalidateChangedItems(std::vector<SourceItem*> *Compiled)
+{
+    typedef std::set<SourceItem*> ItemSet;
+    ItemSet invalid;
+
+    scanDirectory();
+
+    // Collect the items whose source no longer matches the recorded hash.
+    for (SourceMap::iterator I = SourceTable.begin();
+         I != SourceTable.end(); ++I) {
+        SourceItem *Item = I->second;
+        std::auto_ptr<llvm::MemoryBuffer> buffer(
+            llvm::MemoryBuffer::getFile(Item->getSourcePath().c_str()));
+
+        if (!buffer.get()) {
+            invalid.insert(Item);
+            continue;
+        }
+
+        llvm::StringRef text(buffer->getBufferStart(), buffer->getBufferSize());
+        if (hashText(text) != Item->getSourceHash())
+            invalid.insert(Item);
+    }
+
+    // The compilations of clients refer to the declarations of their
+    // dependencies, so invalidate every item which depends on an invalid item.
+    bool changed = !invalid.empty();
+    while (changed) {
+        changed = false;
+        for (SourceMap::iterator I = SourceTable.begin();
+             I != SourceTable.end(); ++I) {
+            SourceItem *Item = I->second;
+            if (invalid.count(Item))
+                continue;
+            for (SourceItem::iterator D = Item->begin(); D != Item->end(); ++D) {
+                if (invalid.count(*D)) {
+                    invalid.insert(Item);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (ItemSet::iterator I = invalid.begin(); I != invalid.end(); ++I) {
+        if (Compiled && (*I)->hasCompilation())
+            Compiled->push_back(*I);
+        (*I)->invalidate();
+    }
+
+    return invalid.size();
+}
+
+void SourceManager::releaseCompilations()
+{
+    for (SourceMap::iterator I = SourceTable.begin();
+         I != SourceTable.end(); ++I)
+        I->second->releaseCompilation();
+}
+
 SourceItem *SourceManager::getOrCreateSourceItem(llvm::sys::Path &path)
 {
     const std::string &key = path.str();
@@ -71,9 +142,13 @@ bool SourceManager::loadDependencies(SourceItem *Item)
         return true;
 
     DepParser::DepSet dependents;
-    TextProvider provider(0, Item->getSourcePath());
+    TextProvider provider(1, Item->getSourcePath());
     DepParser parser(provider, IdPool, Diag);
 
+    // Record the hash of the source while its contents are at hand.
+    Item->sourceHash =
+        hashText(provider.getText(provider.begin(), provider.end()));
+
     if (!parser.parseDependencies(dependents))
         return false;
 
@@ -81,8 +156,9 @@ bool SourceManager::loadDependencies(SourceItem *Item)
     for (DepParser::DepSet::iterator I = dependents.begin();
          I != dependents.end(); ++I) {
         Location loc = I->first;
-        std::string target = I->second;
-        std::transform(target.begin(), target.end(), target.begin(), tolower);
+        // Dependency names are formed from interned identifiers, and so are
+        // already in canonical form.
+        const std::string &target = I->second;
         PathMap::iterator result = PathTable.find(target);
 
         if (result == PathTable.end()) {
@@ -177,6 +253,31 @@ void insertDependencies(SourceItem *Item, llvm::SetVector<SourceItem*> &sources)
 
 } // end anonymous namespace.
 
+std::string SourceItem::getCanonicalName() const
+{
+    std::string name = sourcePath.getBasename();
+    std::transform(name.begin(), name.end(), name.begin(), tolower);
+    return name;
+}
+
+void SourceItem::releaseCompilation()
+{
+    delete cunit;
+    cunit = 0;
+}
+
+void SourceItem::invalidate()
+{
+    IRPath.clear();
+    bitcodePath.clear();
+    interfacePath.clear();
+    releaseCompilation();
+    module = 0;
+    sourceHash = 0;
+    interfaceHash = 0;
+    dependents.clear();
+}
+
 void SourceItem::extractDependencies(std::vector<SourceItem*> &dependencies)
 {
     typedef llvm::SetVector<SourceItem*> SourceSet;
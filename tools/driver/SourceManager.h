@@ -14,8 +14,14 @@
 #include "comma/basic/TextProvider.h"
 #include "llvm/ADT/GraphTraits.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/Support/DataTypes.h"
 #include "llvm/System/Path.h"
 #include <map>
+#include <vector>
+
+namespace llvm {
+class Module;
+} // end llvm namespace.
 
 namespace comma {
 namespace driver {
@@ -42,6 +48,20 @@ public:
     /// Returns the number of SourceItem objects that are currently managed.
     unsigned numSources() const { return SourceTable.size(); }
 
+    /// Discards the state of every SourceItem whose source has changed since
+    /// it was loaded, together with every item depending on a changed item.
+    /// Newly created source files in the working directory are picked up.
+    /// Returns the number of items invalidated.
+    ///
+    /// If \p Compiled is non-null, the invalidated items which held a
+    /// compilation unit are appended to it.
+    unsigned invalidateChangedItems(std::vector<SourceItem*> *Compiled = 0);
+
+    /// Discards the compilation unit of every item.  The declarations of a
+    /// compilation unit belong to an AstResource, so the items must release
+    /// their compilations before that resource is destroyed.
+    void releaseCompilations();
+
 private:
     IdentifierPool &IdPool;
     Diagnostic &Diag;
@@ -86,6 +106,10 @@ private:
         CycleEntry &operator = (const CycleEntry &handle); // Likewise.
     };
 
+    /// Populates the PathTable with the source files in the current working
+    /// directory.
+    void scanDirectory();
+
     /// Returns an existing or creates a new SourceItem object.
     SourceItem *getOrCreateSourceItem(llvm::sys::Path &path);
 
@@ -125,6 +149,16 @@ public:
     /// llvm::sys::Path::empty() returns true.
     const llvm::sys::Path &getBitcodePath() const { return bitcodePath; }
 
+    /// Return the path to the compiled interface file for this SourceItem.
+    ///
+    /// If an interface file has not been associated with this SourceItem,
+    /// llvm::sys::Path::empty() returns true.
+    const llvm::sys::Path &getInterfacePath() const { return interfacePath; }
+
+    /// Returns the canonical (lower case) basename of the source.  This is
+    /// the name by which other items refer to this SourceItem.
+    std::string getCanonicalName() const;
+
     /// Sets the path pointing to the IR file corresponding to this SourceItem.
     void setIRPath(const llvm::sys::Path &path) { IRPath = path; }
 
@@ -132,6 +166,21 @@ public:
     /// SourceItem.
     void setBitcodePath(const llvm::sys::Path &path) { bitcodePath = path; }
 
+    /// Sets the path pointing to the interface file corresponding to this
+    /// SourceItem.
+    void setInterfacePath(const llvm::sys::Path &path) { interfacePath = path; }
+
+    /// Returns a hash of the source text backing this item.
+    uint64_t getSourceHash() const { return sourceHash; }
+
+    //@{
+    /// Returns the hash of this item's public interface.  The value is only
+    /// meaningful once the item has been compiled or loaded from an interface
+    /// file.
+    uint64_t getInterfaceHash() const { return interfaceHash; }
+    void setInterfaceHash(uint64_t hash) { interfaceHash = hash; }
+    //@}
+
     /// Associate a dependency with this item.
     void addDependency(SourceItem &dep) {
         // Taking address of dep is fine since all SourceDependencies are
@@ -157,7 +206,8 @@ public:
     /// Returns the number of dependents associated with this source file.
     unsigned numDependents() const { return dependents.size(); }
 
-    /// Associates a compilation unit with this source item.
+    /// Associates a compilation unit with this source item.  Ownership of the
+    /// compilation unit passes to the SourceItem.
     void setCompilation(CompilationUnit *cunit) {
         this->cunit = cunit;
     }
@@ -166,6 +216,10 @@ public:
     /// it.
     bool hasCompilation() const { return cunit != 0; }
 
+    /// Discards the compilation unit associated with this source item, if
+    /// any.
+    void releaseCompilation();
+
     //@{
     /// Returns the compilation unit associated with this source unit, or null
     /// if there is no associated compilation unit.
@@ -173,13 +227,32 @@ public:
     const CompilationUnit *getCompilation() const { return cunit; }
     //@}
 
+    /// Associates a generated module with this source item.  Ownership of the
+    /// module passes to the SourceItem.
+    void setModule(llvm::Module *M) { module = M; }
+
+    /// Returns the module associated with this source item, or null if there
+    /// is no associated module.  Ownership of the module passes to the caller.
+    llvm::Module *takeModule() {
+        llvm::Module *M = module;
+        module = 0;
+        return M;
+    }
+
 private:
     friend class SourceManager;
 
     /// Constructor for use by SourceManager.
     SourceItem(const llvm::sys::Path &pathname)
         : sourcePath(pathname),
-          cunit(0) { }
+          cunit(0),
+          module(0),
+          sourceHash(0),
+          interfaceHash(0) { }
+
+    /// Discards the dependencies, compilation and outputs of this item so that
+    /// it is processed afresh.
+    void invalidate();
 
     /// Only allow destruction thru SourceManager.
     ~SourceItem() { }
@@ -190,7 +263,11 @@ private:
     llvm::sys::Path sourcePath;
     llvm::sys::Path IRPath;
     llvm::sys::Path bitcodePath;
+    llvm::sys::Path interfacePath;
     CompilationUnit *cunit;
+    llvm::Module *module;
+    uint64_t sourceHash;
+    uint64_t interfaceHash;
     std::vector<SourceItem*> dependents;
 };
 
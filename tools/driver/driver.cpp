@@ -3,20 +3,31 @@
 // the contents of a single file.
 
 #include "config.h"
+#include "Interface.h"
 #include "SourceManager.h"
 #include "comma/ast/Ast.h"
 #include "comma/ast/AstResource.h"
+#include "comma/ast/DeclRewriter.h"
 #include "comma/basic/TextManager.h"
 #include "comma/basic/IdentifierPool.h"
+#include "comma/basic/TimeTrace.h"
 #include "comma/codegen/Generator.h"
 #include "comma/parser/Parser.h"
 #include "comma/typecheck/Checker.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/ExecutionEngine/JIT.h"
+#include "llvm/Linker.h"
 #include "llvm/LLVMContext.h"
 #include "llvm/Module.h"
+#include "llvm/PassManager.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/StandardPasses.h"
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/System/Host.h"
 #include "llvm/System/Path.h"
@@ -24,13 +35,26 @@
 #include "llvm/System/Program.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
 #include "llvm/Target/TargetRegistry.h"
 #include "llvm/Target/TargetSelect.h"
 
-#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 using namespace comma::driver;
@@ -53,6 +77,11 @@ llvm::cl::opt<std::string>
 EntryPoint("e",
            llvm::cl::desc("Comma procedure to use as an entry point."));
 
+// Execute the entry point in memory instead of generating an executable.
+llvm::cl::opt<bool>
+RunProgram("run",
+           llvm::cl::desc("Execute the entry point using the JIT."));
+
 // Emit llvm IR in assembly form.
 llvm::cl::opt<bool>
 EmitLLVM("emit-llvm",
@@ -75,7 +104,16 @@ DestDir("d",
         llvm::cl::desc("Destination directory."),
         llvm::cl::init(""));
 
-// Disable optimizations.
+// Optimization level.
+llvm::cl::opt<std::string>
+OptLevel("O",
+         llvm::cl::desc("Optimization level: -O0, -O1, -O2, -O3 or -Os "
+                        "(default -O2)."),
+         llvm::cl::Prefix,
+         llvm::cl::ZeroOrMore,
+         llvm::cl::init("2"));
+
+// Disable optimizations.  Equivalent to -O0.
 llvm::cl::opt<bool>
 DisableOpt("disable-opt",
            llvm::cl::desc("Disable all optimizations."));
@@ -85,11 +123,53 @@ llvm::cl::opt<bool>
 DumpAST("dump-ast",
         llvm::cl::desc("Dump ast to stderr."));
 
+// Disable the compiled interface cache.
+llvm::cl::opt<bool>
+NoInterfaceCache("fno-interface-cache",
+                 llvm::cl::desc("Do not read or write compiled interfaces."));
+
+// Number of source items to compile concurrently.
+llvm::cl::opt<unsigned>
+Jobs("j",
+     llvm::cl::desc("Number of source items to compile in parallel."),
+     llvm::cl::Prefix,
+     llvm::cl::init(1));
+
+// Write a Chrome trace of the compilation alongside the outputs.
+llvm::cl::opt<bool>
+TimeTraceOutput("ftime-trace",
+                llvm::cl::desc("Write a trace of the time spent compiling "
+                               "each item."));
+
+// Print memory and object statistics.
+llvm::cl::opt<bool>
+PrintStats("print-stats",
+           llvm::cl::desc("Print memory and object statistics to stderr."));
+
+// Write make compatible dependency files alongside the outputs.
+llvm::cl::opt<bool>
+DepFiles("MD",
+         llvm::cl::desc("Write a make dependency file for each output."));
+
+// Serve compilation requests on a UNIX socket.
+llvm::cl::opt<std::string>
+ServerSocket("server",
+             llvm::cl::desc("Serve compilation requests on the given socket."),
+             llvm::cl::value_desc("socket"));
+
+// Hand the compilation to a server.
+llvm::cl::opt<std::string>
+ClientSocket("connect",
+             llvm::cl::desc("Send the compilation request to the server "
+                            "listening on the given socket."),
+             llvm::cl::value_desc("socket"));
+
 namespace {
 
 // Selects a procedure to use as an entry point and generates the corresponding
 // main function.
-bool emitEntryPoint(Generator *Gen, const CompilationUnit &cu)
+bool emitEntryPoint(Generator *Gen, const CompilationUnit &cu,
+                    IdentifierPool &idPool)
 {
     // We must have a well formed entry point string of the form "D.P", where D
     // is the context domain and P is the procedure to call.
@@ -101,14 +181,11 @@ bool emitEntryPoint(Generator *Gen, const CompilationUnit &cu)
         return false;
     }
 
-    std::string capsuleName = EntryPoint.substr(0, dotPos);
-    std::string procName = EntryPoint.substr(dotPos + 1);
-
-    // Bring the capsule and procedure name into canonical lower case form.
-    std::transform(capsuleName.begin(), capsuleName.end(), capsuleName.begin(),
-                   static_cast<int(*)(int)>(std::tolower));
-    std::transform(procName.begin(), procName.end(), procName.begin(),
-                   static_cast<int(*)(int)>(std::tolower));
+    llvm::StringRef capsuleName(EntryPoint.data(), dotPos);
+    llvm::StringRef procName(EntryPoint.data() + dotPos + 1,
+                             EntryPoint.size() - dotPos - 1);
+    IdentifierInfo *capsuleId = &idPool.getFoldedIdentifierInfo(capsuleName);
+    IdentifierInfo *procId = &idPool.getFoldedIdentifierInfo(procName);
 
     // Find a declaration in the given compilation unit which matches the needed
     // capsule.
@@ -117,7 +194,7 @@ bool emitEntryPoint(Generator *Gen, const CompilationUnit &cu)
     for (ctx_iterator I = cu.begin_declarations();
          I != cu.end_declarations(); ++I) {
         if (PackageDecl *package = dyn_cast<PackageDecl>(*I)) {
-            if (capsuleName == package->getString()) {
+            if (package->getIdInfo() == capsuleId) {
                 region = package->getInstance();
                 break;
             }
@@ -131,14 +208,11 @@ bool emitEntryPoint(Generator *Gen, const CompilationUnit &cu)
 
     // Find a nullary procedure declaration with the given name.
     ProcedureDecl *proc = 0;
-    typedef DeclRegion::DeclIter decl_iterator;
-    for (decl_iterator I = region->beginDecls();
-         I != region->endDecls(); ++I) {
+    DeclRegion::PredRange range = region->findDecls(procId);
+    for (DeclRegion::PredIter I = range.first; I != range.second; ++I) {
         ProcedureDecl *candidate = dyn_cast<ProcedureDecl>(*I);
         if (!candidate)
             continue;
-        if (procName != candidate->getString())
-            continue;
         if (candidate->getArity() == 0) {
             proc = candidate;
             break;
@@ -183,7 +257,148 @@ bool outputIR(llvm::Module *M, llvm::sys::Path &outputPath, bool emitBitcode)
      return true;
 }
 
-bool outputExec(std::vector<SourceItem*> &Items)
+// Returns the target machine describing the host, creating it on first use.
+// Returns null and emits a diagnostic if the host is not supported.
+llvm::TargetMachine *getTargetMachine()
+{
+    static llvm::TargetMachine *machine = 0;
+
+    if (machine)
+        return machine;
+
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllAsmPrinters();
+
+    std::string message;
+    std::string triple = llvm::sys::getHostTriple();
+    const llvm::Target *target =
+        llvm::TargetRegistry::lookupTarget(triple, message);
+    if (!target) {
+        std::cerr << "Could not auto-select target architecture for "
+                  << triple << ".\n   : "
+                  << message << std::endl;
+        return 0;
+    }
+
+    machine = target->createTargetMachine(triple, "");
+    return machine;
+}
+
+// Returns the selected optimization level in the range 0 to 3.  -Os selects
+// level 2 with a preference for small code.
+unsigned getOptLevel()
+{
+    if (DisableOpt)
+        return 0;
+    return OptLevel == "s" ? 2 : OptLevel[0] - '0';
+}
+
+// Returns the code generator optimization level matching getOptLevel().
+llvm::CodeGenOpt::Level getCodeGenOptLevel()
+{
+    switch (getOptLevel()) {
+    case 0:
+        return llvm::CodeGenOpt::None;
+    case 1:
+        return llvm::CodeGenOpt::Less;
+    case 2:
+        return llvm::CodeGenOpt::Default;
+    default:
+        return llvm::CodeGenOpt::Aggressive;
+    }
+}
+
+// Reads the bitcode file at the given path into a module.  Returns null and
+// emits a diagnostic on failure.
+llvm::Module *loadBitcode(const llvm::sys::Path &path,
+                          llvm::LLVMContext &context)
+{
+    std::string message;
+    llvm::Module *M = 0;
+    std::auto_ptr<llvm::MemoryBuffer> buffer(
+        llvm::MemoryBuffer::getFile(path.c_str(), &message));
+
+    if (buffer.get())
+        M = llvm::ParseBitcodeFile(buffer.get(), context, &message);
+
+    if (!M)
+        llvm::errs() << "Could not read `" << path.str() << "': "
+                     << message << '\n';
+    return M;
+}
+
+// Runs the link time optimization pipeline over the given module (unless
+// optimizations are disabled) and emits native assembly to the given path.
+bool outputAssembly(llvm::Module *M, llvm::TargetMachine &machine,
+                    const llvm::sys::Path &outputPath)
+{
+    std::string message;
+    llvm::raw_fd_ostream output(outputPath.c_str(), message, 0);
+    if (!message.empty()) {
+        llvm::errs() << message << '\n';
+        return false;
+    }
+    llvm::formatted_raw_ostream stream(output);
+
+    if (getOptLevel() > 0) {
+        TimeTraceScope trace("Optimize", M->getModuleIdentifier());
+        llvm::PassManager PM;
+        PM.add(new llvm::TargetData(*machine.getTargetData()));
+        llvm::createStandardLTOPasses(&PM, true, true, false);
+        PM.run(*M);
+    }
+
+    llvm::PassManager PM;
+    PM.add(new llvm::TargetData(*machine.getTargetData()));
+    if (machine.addPassesToEmitFile(
+            PM, stream, llvm::TargetMachine::CGFT_AssemblyFile,
+            getCodeGenOptLevel())) {
+        llvm::errs() << "Target does not support assembly generation.\n";
+        return false;
+    }
+
+    TimeTraceScope trace("Emit native code", M->getModuleIdentifier());
+    PM.run(*M);
+    return true;
+}
+
+// Links the modules of the given items into a single module with the given
+// name.  Items compiled during this invocation hand over their modules
+// directly, all others are read from their bitcode files.  Returns null and
+// emits a diagnostic on failure.
+llvm::Module *linkProgram(std::vector<SourceItem*> &Items,
+                          const std::string &name,
+                          llvm::TargetMachine &machine,
+                          llvm::LLVMContext &context)
+{
+    TimeTraceScope trace("Link", name);
+    std::auto_ptr<llvm::Module> program(new llvm::Module(name, context));
+    program->setTargetTriple(llvm::sys::getHostTriple());
+    program->setDataLayout(
+        machine.getTargetData()->getStringRepresentation());
+
+    for (unsigned i = 0; i < Items.size(); ++i) {
+        SourceItem *Item = Items[i];
+        std::auto_ptr<llvm::Module> M(Item->takeModule());
+
+        if (!M.get())
+            M.reset(loadBitcode(Item->getBitcodePath(), context));
+        if (!M.get())
+            return 0;
+
+        std::string message;
+        if (llvm::Linker::LinkModules(program.get(), M.get(), &message)) {
+            llvm::errs() << "Could not link `"
+                         << Item->getSourcePath().str() << "': "
+                         << message << '\n';
+            return 0;
+        }
+    }
+
+    return program.release();
+}
+
+bool outputExec(std::vector<SourceItem*> &Items, llvm::LLVMContext &context)
 {
     // Determine the output file.  If no name was explicity given on the command
     // line derive the output file from the input file name.
@@ -196,84 +411,140 @@ bool outputExec(std::vector<SourceItem*> &Items)
     else
         outputPath = OutputFile;
 
-    // Locate llvm-ld.
-    llvm::sys::Path llvm_ld = llvm::sys::Program::FindProgramByName("llvm-ld");
-    if (llvm_ld.isEmpty()) {
-        llvm::errs() << "Cannot locate `llvm-ld'.\n";
+    llvm::TargetMachine *machine = getTargetMachine();
+    if (!machine)
+        return false;
+
+    std::auto_ptr<llvm::Module> program(
+        linkProgram(Items, outputPath.str(), *machine, context));
+    if (!program.get())
+        return false;
+
+    // Generate native assembly for the program.
+    llvm::sys::Path asmPath(outputPath);
+    asmPath.appendSuffix("s");
+    if (!outputAssembly(program.get(), *machine, asmPath))
+        return false;
+
+    // Locate the system compiler driver to assemble and link against the
+    // runtime.
+    llvm::sys::Path gcc = llvm::sys::Program::FindProgramByName("gcc");
+    if (gcc.isEmpty()) {
+        llvm::errs() << "Cannot locate `gcc'.\n";
         return false;
     }
 
     // Generate the library path which contains the runtime library.
     std::string libflag = "-L" COMMA_BUILD_ROOT "/lib";
 
-    // Build the argument vector for llvm-ld and execute.
+    // Build the argument vector and execute.
     llvm::SmallVector<const char*, 16> args;
-    args.push_back(llvm_ld.c_str());
-    args.push_back("-native");
+    args.push_back(gcc.c_str());
     args.push_back("-o");
     args.push_back(outputPath.c_str());
+    args.push_back(asmPath.c_str());
     args.push_back(libflag.c_str());
     args.push_back("-lruntime");
-
-    // Disable optimizations if requested.
-    if (DisableOpt)
-        args.push_back("-disable-opt");
-
-    // Append all of the bitcode file names.
-    for (unsigned i = 0; i < Items.size(); ++i)
-        args.push_back(Items[i]->getBitcodePath().c_str());
-
-    // Terminate the argument list.
     args.push_back(0);
 
     std::string message;
-    if (llvm::sys::Program::ExecuteAndWait(
-            llvm_ld, &args[0], 0, 0, 0, 0, &message)) {
+    bool failed;
+    {
+        TimeTraceScope trace("Assemble and link", outputPath.str());
+        failed = llvm::sys::Program::ExecuteAndWait(
+            gcc, &args[0], 0, 0, 0, 0, &message);
+    }
+    asmPath.eraseFromDisk();
+
+    if (failed) {
         llvm::errs() << "Could not generate executable: " << message << '\n';
         return false;
     }
     return true;
 }
 
+// Links the given items and executes the entry point using the JIT.  The
+// runtime is linked into the driver itself, so references to it resolve
+// against the running process.  Returns the exit status of the program, or -1
+// if it could not be executed.
+int runProgram(std::vector<SourceItem*> &Items, llvm::LLVMContext &context)
+{
+    llvm::TargetMachine *machine = getTargetMachine();
+    if (!machine)
+        return -1;
+
+    llvm::InitializeNativeTarget();
+    llvm::JITExceptionHandling = true;
+
+    llvm::Module *program = linkProgram(Items, InputFile, *machine, context);
+    if (!program)
+        return -1;
+
+    // The execution engine takes ownership of the module.
+    std::string message;
+    std::auto_ptr<llvm::ExecutionEngine> engine(
+        llvm::EngineBuilder(program)
+        .setEngineKind(llvm::EngineKind::JIT)
+        .setErrorStr(&message)
+        .setOptLevel(getCodeGenOptLevel())
+        .create());
+    if (!engine.get()) {
+        llvm::errs() << "Could not create execution engine: "
+                     << message << '\n';
+        return -1;
+    }
+
+    llvm::Function *entry = program->getFunction("main");
+    if (!entry) {
+        llvm::errs() << "Program does not define an entry point.\n";
+        return -1;
+    }
+
+    std::vector<std::string> args;
+    args.push_back(InputFile);
+    const char *envp[] = { 0 };
+
+    TimeTraceScope trace("Run", InputFile);
+    engine->runStaticConstructorsDestructors(false);
+    int status = engine->runFunctionAsMain(entry, args, envp);
+    engine->runStaticConstructorsDestructors(true);
+    return status;
+}
+
 bool generateSourceItem(SourceItem *Item, TextManager &Manager,
                         AstResource &Resource, Diagnostic &Diag,
-                        bool EmitEntry = false)
+                        llvm::LLVMContext &context, bool EmitEntry = false)
 {
-    llvm::InitializeAllTargets();
-
     // FIXME: CodeGen should handle all of this.
-    llvm::LLVMContext context;
-    std::string message;
-    const llvm::Target *target;
     const llvm::TargetMachine *machine;
     const llvm::TargetData *data;
 
+    if (!(machine = getTargetMachine()))
+        return false;
+
     std::auto_ptr<llvm::Module> M(
         new llvm::Module(Item->getSourcePath().str(), context));
 
-    std::string triple = llvm::sys::getHostTriple();
-    M->setTargetTriple(triple);
-    target = llvm::TargetRegistry::lookupTarget(triple, message);
-    if (!target) {
-        std::cerr << "Could not auto-select target architecture for "
-                  << triple << ".\n   : "
-                  << message << std::endl;
-        return false;
-    }
-
-    machine = target->createTargetMachine(triple, "");
+    M->setTargetTriple(llvm::sys::getHostTriple());
     data = machine->getTargetData();
     M->setDataLayout(data->getStringRepresentation());
 
     std::auto_ptr<Generator> Gen(
         Generator::create(M.get(), *data, Manager, Resource));
+    Gen->setOptimizationLevel(getOptLevel(), OptLevel == "s");
 
     CompilationUnit *CU = Item->getCompilation();
-    Gen->emitCompilationUnit(CU);
+    {
+        TimeTraceScope trace("CodeGen", Item->getSourcePath().str());
+        Gen->emitCompilationUnit(CU);
+    }
+
+    if (PrintStats)
+        Gen->printStats(llvm::errs());
 
     // Generate an entry point and native executable if requested.
     if (EmitEntry && !EntryPoint.empty()) {
-        if (!emitEntryPoint(Gen.get(), *CU))
+        if (!emitEntryPoint(Gen.get(), *CU, Resource.getIdentifierPool()))
             return false;
     }
 
@@ -317,26 +588,28 @@ bool generateSourceItem(SourceItem *Item, TextManager &Manager,
         Item->setBitcodePath(output);
     }
 
+    // Retain the module if it is to be linked into an executable.
+    if (!EntryPoint.empty())
+        Item->setModule(M.release());
+
     return true;
 }
 
-Decl *findPrincipleDeclaration(Diagnostic &Diag, SourceItem *Item)
+Decl *findPrincipleDeclaration(Diagnostic &Diag, IdentifierPool &idPool,
+                               SourceItem *Item)
 {
     CompilationUnit *CU = Item->getCompilation();
     assert(CU && "Dependency not resolved!");
 
     std::string target = Item->getSourcePath().getBasename();
-    std::transform(target.begin(), target.end(), target.begin(), tolower);
+    IdentifierInfo *targetId = &idPool.getFoldedIdentifierInfo(target);
 
     typedef CompilationUnit::decl_iterator iterator;
     iterator I = CU->begin_declarations();
     iterator E = CU->end_declarations();
     for ( ; I != E; ++I) {
         Decl *decl = *I;
-        std::string candidate = decl->getIdInfo()->getString();
-        std::transform(candidate.begin(), candidate.end(), candidate.begin(),
-                       tolower);
-        if (candidate == target)
+        if (decl->getIdInfo() == targetId)
             return decl;
     }
 
@@ -346,93 +619,752 @@ Decl *findPrincipleDeclaration(Diagnostic &Diag, SourceItem *Item)
     return 0;
 }
 
-bool compileSourceItem(SourceItem *RootItem, AstResource &Resource,
-                       Diagnostic &Diag)
+// Returns the path within the destination directory for an output file of the
+// given item with the given suffix.
+llvm::sys::Path getDestPath(SourceItem *Item, const std::string &suffix)
 {
-    typedef std::vector<SourceItem*>::reverse_iterator source_iterator;
-    std::vector<SourceItem*> Items;
+    llvm::sys::Path path(DestDir);
+    path.appendComponent(Item->getSourcePath().getBasename());
+    path.appendSuffix(suffix);
+    return path;
+}
 
-    RootItem->extractDependencies(Items);
+// Attempts to satisfy the given item from a previously written interface file.
+// Returns true if the interface is current with respect to the items source
+// and dependencies, the accompanying code was generated with the given entry
+// point, and all outputs requested of the item are available.
+bool loadInterface(SourceItem *Item, const std::string &entry = "")
+{
+    if (NoInterfaceCache)
+        return false;
 
-    // If an entry point was defined we must generate an executable.  Ensure
-    // bitcode is generated in this case.
-    if (!EntryPoint.empty())
-        EmitLLVMBitcode = true;
+    llvm::sys::Path interfacePath = getDestPath(Item, "cmi");
+    InterfaceFile Interface;
+    if (!Interface.readTrailer(interfacePath) || !Interface.isCurrent(Item))
+        return false;
+
+    if (!SyntaxOnly && Interface.getEntryPoint() != entry)
+        return false;
+
+    // Programs are linked from the bitcode of current items, so an item is
+    // only current when its bitcode is available.
+    llvm::sys::Path IRPath = getDestPath(Item, "ll");
+    llvm::sys::Path bitcodePath = getDestPath(Item, "bc");
+    if (!SyntaxOnly) {
+        bool needBitcode = EmitLLVMBitcode || !EntryPoint.empty();
+        if (EmitLLVM && !IRPath.exists())
+            return false;
+        if (needBitcode && !bitcodePath.exists())
+            return false;
+        if (EmitLLVM)
+            Item->setIRPath(IRPath);
+        if (needBitcode)
+            Item->setBitcodePath(bitcodePath);
+    }
 
-    // Process the dependencies in reverse order.
-    TextManager TM;
+    Item->setInterfacePath(interfacePath);
+    Item->setInterfaceHash(Interface.getInterfaceHash());
+    return true;
+}
+
+// Writes a make compatible dependency file next to the outputs of the given
+// item.  The outputs depend on the source of the item and of every item it
+// depends on, directly or indirectly.
+bool outputDepFile(SourceItem *Item)
+{
+    llvm::sys::Path depPath = getDestPath(Item, "d");
+    std::string message;
+    llvm::raw_fd_ostream output(depPath.c_str(), message, 0);
+    if (!message.empty()) {
+        llvm::errs() << "Could not write dependency file: " << message << '\n';
+        return false;
+    }
+
+    const llvm::sys::Path *targets[] = {
+        &Item->getIRPath(), &Item->getBitcodePath(), &Item->getInterfacePath()
+    };
+    bool first = true;
+    for (unsigned i = 0; i < llvm::array_lengthof(targets); ++i) {
+        if (targets[i]->isEmpty())
+            continue;
+        if (!first)
+            output << ' ';
+        output << targets[i]->str();
+        first = false;
+    }
+    output << ':';
+
+    std::vector<SourceItem*> sources;
+    Item->extractDependencies(sources);
+    for (unsigned i = 0; i < sources.size(); ++i)
+        output << " \\\n  " << sources[i]->getSourcePath().str();
+    output << '\n';
+
+    // Emit an empty rule for each dependency so that make does not fail
+    // should one of them be removed.
+    for (unsigned i = 1; i < sources.size(); ++i)
+        output << '\n' << sources[i]->getSourcePath().str() << ":\n";
+    return true;
+}
+
+// Parses and checks the given item, either from its source or, when
+// reuseInterface is true, from its interface file.  The dependencies of the
+// item must have been compiled beforehand.  Items compiled from source also
+// have their code generated and, when writeInterfaces is true, their interface
+// recorded.
+bool compileItem(SourceItem *Item, bool reuseInterface, bool emitEntry,
+                 bool writeInterfaces, AstResource &Resource, TextManager &TM,
+                 Diagnostic &Diag, llvm::LLVMContext &Context)
+{
+    TimeTraceScope trace(reuseInterface ? "Load interface" : "Compile",
+                         Item->getSourcePath().str());
+    TextProvider &TP = reuseInterface ?
+        TM.create(Item->getInterfacePath()) :
+        TM.create(Item->getSourcePath());
+    std::auto_ptr<CompilationUnit> CU(
+        new CompilationUnit(Item->getSourcePath()));
+    std::auto_ptr<Checker> TC(
+        Checker::create(TM, Diag, Resource, CU.get()));
+
+    Parser P(TP, Resource.getIdentifierPool(), *TC, Diag);
+
+    // Initialize the compilation unit with any needed dependencies.
+    for (SourceItem::iterator D = Item->begin(); D != Item->end(); ++D) {
+        // FIXME: We allow multiple declarations in compilation units for
+        // now (so that the test suite does not break).  In the future we
+        // will probably insist that a source item provides only one unit
+        // with the required name.  For now, ensure that at least one unit
+        // exists with the required name (all other declarations are
+        // effectively private within the source item).
+        Decl *principle;
+        if (!(principle = findPrincipleDeclaration(
+                  Diag, Resource.getIdentifierPool(), *D)))
+            return false;
+        CU->addDependency(principle);
+    }
+
+    // Drive the parser and type checker.  Lexing is performed on demand
+    // and so is attributed to the parse.
+    {
+        TimeTraceScope trace("Parse", Item->getSourcePath().str());
+        P.parseCompilationUnit();
+    }
+
+    // Capture the public view of the source before it is released.
+    InterfaceFile Interface;
+    if (writeInterfaces && !reuseInterface && Diag.numErrors() == 0)
+        Interface.extract(TP, Resource.getIdentifierPool(), Diag);
+
+    // We are finished with the source code.  Close the TextProvider and
+    // release the associated resources.
+    TP.close();
+
+    // Dump the ast if we were asked.
+    if (DumpAST) {
+        typedef CompilationUnit::decl_iterator iterator;
+        iterator I = CU->begin_declarations();
+        iterator E = CU->end_declarations();
+        for ( ; I != E; ++I) {
+            Decl *decl = *I;
+            decl->dump();
+            llvm::errs() << '\n';
+        }
+    }
+
+    // Stop processing if the SourceItem did not parse/typecheck cleanly.
+    if (Diag.numErrors() != 0)
+        return false;
+
+    // Add the compilation unit to the SourceItem.
+    Item->setCompilation(CU.release());
+
+    // Reused items are complete at this point.
+    if (reuseInterface)
+        return true;
+
+    // Codegen if needed.
+    if (!SyntaxOnly) {
+        if (!generateSourceItem(Item, TM, Resource, Diag,
+                                Context, emitEntry))
+            return false;
+    }
+
+    // Record the interface for use by subsequent compilations.
+    if (writeInterfaces) {
+        llvm::sys::Path interfacePath = getDestPath(Item, "cmi");
+        Interface.stamp(Item);
+        if (emitEntry)
+            Interface.setEntryPoint(EntryPoint);
+        if (!Interface.write(interfacePath))
+            return false;
+        Item->setInterfacePath(interfacePath);
+        Item->setInterfaceHash(Interface.getInterfaceHash());
+    }
+
+    if (DepFiles && !SyntaxOnly && !outputDepFile(Item))
+        return false;
+
+    return true;
+}
+
+// Compiles the dependencies of the given item which have not been compiled
+// yet, so that the item itself can be compiled.  Such dependencies are
+// current and are compiled from their interface files.
+bool loadDependencies(SourceItem *Item, AstResource &Resource,
+                      TextManager &TM, Diagnostic &Diag,
+                      llvm::LLVMContext &Context)
+{
+    for (SourceItem::iterator D = Item->begin(); D != Item->end(); ++D) {
+        SourceItem *Dep = *D;
+        if (Dep->hasCompilation())
+            continue;
+        if (!loadDependencies(Dep, Resource, TM, Diag, Context) ||
+            !compileItem(Dep, true, false, false, Resource, TM, Diag, Context))
+            return false;
+    }
+    return true;
+}
+
+// Compiles the given items (as produced by SourceItem::extractDependencies) in
+// dependency order.
+//
+// An item is current when its interface file matches its source and the
+// interfaces of its dependencies.  The dependencies of an item are settled
+// before the item itself, so a dependency compiled afresh is compared by its
+// new interface, and a change confined to the body of a dependency leaves its
+// clients current.  Current items are not compiled again.  Such an item is
+// parsed from its interface file only when some client of the item needs to
+// be compiled, and is otherwise skipped entirely.
+//
+// The nodes of the root item are allocated from RootResource, which is either
+// Resource itself or a child of it, and those of its dependencies from
+// Resource.
+bool compileItems(SourceItem *RootItem, std::vector<SourceItem*> &Items,
+                  AstResource &Resource, AstResource &RootResource,
+                  TextManager &TM, Diagnostic &Diag,
+                  llvm::LLVMContext &Context, bool EmitEntry)
+{
+    typedef std::vector<SourceItem*>::reverse_iterator source_iterator;
+
+    // Interface files are written alongside the generated IR.
+    bool writeInterfaces =
+        !(NoInterfaceCache || SyntaxOnly) && (EmitLLVM || EmitLLVMBitcode);
+
+    // Items are ordered such that clients precede their dependencies, so
+    // process them in reverse.
     for (source_iterator I = Items.rbegin(), E = Items.rend(); I != E; ++I) {
         SourceItem *Item = *I;
-        TextProvider &TP = TM.create(Item->getSourcePath());
-        std::auto_ptr<CompilationUnit> CU(
-            new CompilationUnit(Item->getSourcePath()));
-        std::auto_ptr<Checker> TC(
-            Checker::create(TM, Diag, Resource, CU.get()));
-
-        Parser P(TP, Resource.getIdentifierPool(), *TC, Diag);
-
-        // Initialize the compilation unit with any needed dependencies.
-        for (SourceItem::iterator D = Item->begin(); D != Item->end(); ++D) {
-            // FIXME: We allow multiple declarations in compilation units for
-            // now (so that the test suite does not break).  In the future we
-            // will probably insist that a source item provides only one unit
-            // with the required name.  For now, ensure that at least one unit
-            // exists with the required name (all other declarations are
-            // effectively private within the source item).
-            Decl *principle;
-            if (!(principle = findPrincipleDeclaration(Diag, *D)))
+
+        // Items checked by an earlier request to a compile server are
+        // complete.  Only the code for the root item is generated anew.
+        if (Item->hasCompilation()) {
+            if (Item == RootItem && !SyntaxOnly &&
+                !generateSourceItem(Item, TM, RootResource, Diag,
+                                    Context, EmitEntry))
                 return false;
-            CU->addDependency(principle);
+            continue;
         }
 
-        // Drive the parser and type checker.
-        P.parseCompilationUnit();
+        // The root item must be checked afresh if its diagnostics or AST are
+        // wanted.
+        bool current;
+        if (Item == RootItem)
+            current = writeInterfaces && !DumpAST &&
+                loadInterface(Item, EmitEntry ? EntryPoint : "");
+        else
+            current = loadInterface(Item);
+        if (current)
+            continue;
+
+        bool isRoot = Item == RootItem;
+        if (!loadDependencies(Item, Resource, TM, Diag, Context) ||
+            !compileItem(Item, false, EmitEntry && isRoot, writeInterfaces,
+                         isRoot ? RootResource : Resource, TM, Diag, Context))
+            return false;
+    }
+
+    return true;
+}
+
+// Returns true if every dependency of the given item is a member of the given
+// set.
+bool dependenciesComplete(SourceItem *Item, const std::set<SourceItem*> &Done)
+{
+    for (SourceItem::iterator I = Item->begin(); I != Item->end(); ++I) {
+        if (!Done.count(*I))
+            return false;
+    }
+    return true;
+}
 
-        // We are finished with the source code.  Close the TextProvider and
-        // release the associated resources.
-        TP.close();
-
-        // Dump the ast if we were asked.
-        if (DumpAST) {
-            typedef CompilationUnit::decl_iterator iterator;
-            iterator I = CU->begin_declarations();
-            iterator E = CU->end_declarations();
-            for ( ; I != E; ++I) {
-                Decl *decl = *I;
-                decl->dump();
-                llvm::errs() << '\n';
+// Compiles the dependencies of the root item using a pool of worker processes.
+//
+// Each worker is a fork of the driver which compiles a single item from source
+// with a private LLVMContext, TextManager and Checker, loading the item's
+// dependencies from the interface files written by previous workers.  An item
+// is scheduled as soon as all of its dependencies are complete.
+bool compileInParallel(SourceItem *RootItem, std::vector<SourceItem*> &Items,
+                       AstResource &Resource, Diagnostic &Diag)
+{
+    // Create the destination directory up front so that the workers do not
+    // race to do so.
+    llvm::sys::Path output(DestDir);
+    if (!output.exists()) {
+        std::string message;
+        if (output.createDirectoryOnDisk(true, &message)) {
+            llvm::errs() << "Could not create output directory: "
+                         << message << '\n';
+            return false;
+        }
+    }
+
+    // Items awaiting compilation, leaves first.
+    std::vector<SourceItem*> pending;
+    for (unsigned i = Items.size(); i > 0; --i) {
+        if (Items[i - 1] != RootItem)
+            pending.push_back(Items[i - 1]);
+    }
+
+    std::set<SourceItem*> done;
+    std::map<pid_t, SourceItem*> running;
+    bool failed = false;
+
+    while (!running.empty() || (!pending.empty() && !failed)) {
+        // Start every ready item while workers are available.
+        unsigned index = 0;
+        while (!failed && index < pending.size() && running.size() < Jobs) {
+            SourceItem *Item = pending[index];
+            if (!dependenciesComplete(Item, done)) {
+                ++index;
+                continue;
+            }
+            pending.erase(pending.begin() + index);
+
+            // Items already checked or with a current interface need no
+            // worker.  Completing one may make earlier entries ready, so
+            // rescan.
+            if (Item->hasCompilation() || loadInterface(Item)) {
+                done.insert(Item);
+                index = 0;
+                continue;
             }
+
+            pid_t pid = fork();
+            if (pid < 0) {
+                llvm::errs() << "Could not start compilation worker.\n";
+                failed = true;
+                break;
+            }
+
+            if (pid == 0) {
+                llvm::LLVMContext context;
+                TextManager manager;
+                std::vector<SourceItem*> deps;
+                Item->extractDependencies(deps);
+                if (TimeTraceOutput)
+                    TimeTrace::enable();
+                bool status = compileItems(Item, deps, Resource, Resource,
+                                           manager, Diag, context, false);
+                if (TimeTraceOutput)
+                    TimeTrace::write(getDestPath(Item, "json").str());
+
+                // The worker shares the parent's state, so leave without
+                // running exit handlers or static destructors.  Flush the
+                // diagnostic streams by hand since _exit will not.
+                llvm::errs().flush();
+                llvm::outs().flush();
+                std::cerr.flush();
+                _exit(status ? 0 : 1);
+            }
+
+            running[pid] = Item;
         }
 
-        // Stop processing if the SourceItem did not parse/typecheck cleanly.
-        if (Diag.numErrors() != 0)
+        // The dependency graph is acyclic, so something must be running
+        // whenever items remain pending.
+        if (running.empty())
+            break;
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            llvm::errs() << "Lost track of compilation workers.\n";
             return false;
+        }
+
+        std::map<pid_t, SourceItem*>::iterator I = running.find(pid);
+        if (I == running.end())
+            continue;
 
-        // Add the compilation unit to the SourceItem.
-        Item->setCompilation(CU.release());
+        SourceItem *Item = I->second;
+        running.erase(I);
 
-        // Codegen if needed.
-        if (!SyntaxOnly) {
-            bool emitEntry = Item == RootItem;
-            if (!generateSourceItem(Item, TM, Resource, Diag, emitEntry))
-                return false;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed = true;
+        else if (!loadInterface(Item)) {
+            llvm::errs() << "Worker did not produce an interface for `"
+                         << Item->getSourcePath().str() << "'.\n";
+            failed = true;
         }
+        else
+            done.insert(Item);
     }
 
-    // FIXME: We might want to insist that the root source item declares a unit
-    // with a matching name.  However, such a constraint would break the test
-    // suite ATM since the current convention is to use an entry point named
-    // Test.Run regardless of the file name (or perhaps we should not care,
-    // since the dependency graph is cycle free nothing can refer to the root
-    // item anyway).
+    return !failed && pending.empty();
+}
 
-    // If an entry point was defined, generate a native executable.
-    if (!EntryPoint.empty())
-        return outputExec(Items);
+// Compiles the given item and all of its dependencies.  The nodes of the item
+// itself are allocated from RootResource, as for compileItems.  Returns the
+// exit status of the driver.
+int compileSourceItem(SourceItem *RootItem, AstResource &Resource,
+                      AstResource &RootResource, TextManager &TM,
+                      Diagnostic &Diag)
+{
+    std::vector<SourceItem*> Items;
+
+    RootItem->extractDependencies(Items);
+
+    if (RunProgram && EntryPoint.empty()) {
+        llvm::errs() << "An entry point is required to run a program.\n";
+        return 1;
+    }
+
+    // If an entry point was defined we must generate an executable.  The
+    // modules are linked in memory, but bitcode is retained so that later
+    // compilations can reuse the items.  Programs executed by the JIT never
+    // touch the file system unless asked to, but once interfaces are written
+    // the bitcode must accompany them.
+    if (!EntryPoint.empty() && !NoInterfaceCache &&
+        (!RunProgram || EmitLLVM))
+        EmitLLVMBitcode = true;
+
+    // Parallel workers hand their results to one another through interface
+    // files, which in turn require bitcode to be written.
+    if (Jobs > 1 && !(SyntaxOnly || NoInterfaceCache)) {
+        EmitLLVMBitcode = true;
+        if (!compileInParallel(RootItem, Items, Resource, Diag))
+            return 1;
+    }
+
+    if (TimeTraceOutput)
+        TimeTrace::enable();
+
+    llvm::LLVMContext Context;
+    int status = 1;
+    if (compileItems(RootItem, Items, Resource, RootResource,
+                     TM, Diag, Context, true)) {
+        // FIXME: We might want to insist that the root source item declares a
+        // unit with a matching name.  However, such a constraint would break
+        // the test suite ATM since the current convention is to use an entry
+        // point named Test.Run regardless of the file name (or perhaps we
+        // should not care, since the dependency graph is cycle free nothing
+        // can refer to the root item anyway).
+
+        // If an entry point was defined, either run the program directly or
+        // generate a native executable.
+        if (RunProgram) {
+            status = runProgram(Items, Context);
+            status = status < 0 ? 1 : status;
+        }
+        else if (!EntryPoint.empty())
+            status = outputExec(Items, Context) ? 0 : 1;
+        else
+            status = 0;
+    }
+
+    // Release any modules left behind by a failure before their context is
+    // destroyed.  The items themselves may outlive this call.
+    for (unsigned i = 0; i < Items.size(); ++i)
+        delete Items[i]->takeModule();
+
+    // Items compiled by parallel workers are traced in files of their own.
+    if (TimeTraceOutput) {
+        if (!TimeTrace::write(getDestPath(RootItem, "json").str()))
+            return 1;
+    }
+
+    return status;
+}
+
+// Prints statistics covering the long lived structures of the compiler.
+void printStats(IdentifierPool &IdPool, AstResource &Resource,
+                TextManager &TM)
+{
+    llvm::raw_ostream &stream = llvm::errs();
+    Ast::printStats(stream);
+    stream << "*** DeclRewriter statistics:\n"
+           << "  " << DeclRewriter::getNumRewrittenDecls()
+           << " declarations rewritten\n";
+    Resource.printStats(stream);
+    IdPool.printStats(stream);
+    TM.printStats(stream);
+}
+
+// Returns true if the given path names a readable Comma source file, emitting
+// a diagnostic otherwise.
+bool checkInputPath(const llvm::sys::Path &path)
+{
+    if (!path.canRead()) {
+        llvm::errs() << "Cannot open `" << path.str() <<"' for reading.\n";
+        return false;
+    }
+    if (path.getSuffix() != "cms") {
+        llvm::errs() << "Input files must have a `.cms' extension.\n";
+        return false;
+    }
+    return true;
+}
+
+// Returns a socket address for the given path, or false if the path is too
+// long to be represented.
+bool getSocketAddress(const std::string &path, sockaddr_un &addr)
+{
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
 
+    if (path.size() >= sizeof(addr.sun_path)) {
+        llvm::errs() << "Socket path `" << path << "' is too long.\n";
+        return false;
+    }
+    std::strcpy(addr.sun_path, path.c_str());
     return true;
 }
 
+// Writes the given data to the given descriptor in full.
+bool writeAll(int fd, const char *data, size_t size)
+{
+    while (size) {
+        ssize_t count = write(fd, data, size);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+// Processes a single request received by a compile server.
+//
+// A request is the absolute path of the source to compile terminated by a new
+// line.  Everything the driver would report on stderr is sent back to the
+// client, followed by a NUL byte and the exit status of the compilation, which
+// is also returned.  If \p release is true the state left by the previous
+// request is released even if no item was invalidated.
+//
+// The root item of a request is compiled into \p Generation, a child of \p
+// Resource, and \p GenerationItem records the item compiled there.  The
+// generation is replaced whenever the root changes or another item is
+// requested, leaving the dependencies in \p Resource untouched.
+int serveRequest(int client, SourceManager &SM,
+                 std::auto_ptr<AstResource> &Resource,
+                 std::auto_ptr<AstResource> &Generation,
+                 SourceItem *&GenerationItem,
+                 std::auto_ptr<TextManager> &TM, Diagnostic &Diag,
+                 bool release)
+{
+    std::string request;
+    char c;
+    while (read(client, &c, 1) == 1 && c != '\n')
+        request.push_back(c);
+
+    // Route all diagnostics to the client for the duration of the request.
+    int savedErr = dup(2);
+    dup2(client, 2);
+
+    int status = 1;
+    llvm::sys::Path path(request);
+    if (checkInputPath(path)) {
+        // Uniqued types and the language defined declarations are shared by
+        // every item in Resource, so the nodes of an invalidated dependency
+        // cannot be released on their own.  Once such an item is invalidated
+        // the whole AST is released, together with the text providers of
+        // every source and interface read, and the remaining items are
+        // reloaded from their interfaces.  A failed request leaves nodes and
+        // providers behind which no item refers to, so they are released in
+        // the same way.
+        std::vector<SourceItem*> compiled;
+        SM.invalidateChangedItems(&compiled);
+        for (unsigned i = 0; i < compiled.size(); ++i)
+            release |= compiled[i] != GenerationItem;
+        if (release) {
+            IdentifierPool &idPool = Resource->getIdentifierPool();
+            SM.releaseCompilations();
+            Generation.reset();
+            GenerationItem = 0;
+            Resource.reset();
+            Resource.reset(new AstResource(idPool));
+            TM.reset();
+            TM.reset(new TextManager());
+        }
+
+        Diag.reset();
+        InputFile = path.str();
+        if (SourceItem *Item = SM.getSourceItem(path)) {
+            // Nothing refers to the previous root, so it is released on its
+            // own when it changed or another item is requested.  A root which
+            // is a dependency of an earlier request already belongs to
+            // Resource.
+            if (Item != GenerationItem || !Item->hasCompilation()) {
+                if (GenerationItem) {
+                    GenerationItem->releaseCompilation();
+                    TM->release(GenerationItem->getSourcePath());
+                }
+                Generation.reset();
+                Generation.reset(new AstResource(*Resource));
+                GenerationItem = Item->hasCompilation() ? 0 : Item;
+            }
+            status = compileSourceItem(Item, *Resource, *Generation,
+                                       *TM, Diag);
+        }
+        if (PrintStats)
+            printStats(Resource->getIdentifierPool(), *Resource, *TM);
+    }
+
+    std::cerr.flush();
+    llvm::errs().flush();
+    dup2(savedErr, 2);
+    close(savedErr);
+
+    char buff[16];
+    int length = std::sprintf(buff, "%c%d", 0, status);
+    writeAll(client, buff, length);
+    return status;
+}
+
+// Runs the driver as a compile server.
+//
+// The identifier pool, AST resource, source manager and the checked
+// compilation units of every item are retained between requests.  Before each
+// request the items whose source changed are invalidated (along with their
+// clients), so that only those items are parsed and checked again.  The root
+// of the most recent request is held in an AST resource of its own, which is
+// replaced whenever the root changes.  The remaining AST resource and the text
+// manager are replaced whenever any other item is invalidated or a request
+// fails, so that the nodes and text of stale compilations are released.
+int runServer()
+{
+    if (RunProgram) {
+        llvm::errs() << "Programs cannot be run by a compile server.\n";
+        return 1;
+    }
+
+    sockaddr_un addr;
+    if (!getSocketAddress(ServerSocket, addr))
+        return 1;
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        llvm::errs() << "Could not create socket: "
+                     << std::strerror(errno) << '\n';
+        return 1;
+    }
+
+    unlink(addr.sun_path);
+    if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) ||
+        listen(listener, SOMAXCONN)) {
+        llvm::errs() << "Could not listen on `" << ServerSocket << "': "
+                     << std::strerror(errno) << '\n';
+        close(listener);
+        return 1;
+    }
+
+    // Clients which disconnect early must not take the server down.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Compiled items are linked from their bitcode, since modules do not
+    // survive between requests.
+    if (!EntryPoint.empty())
+        EmitLLVMBitcode = true;
+
+    Diagnostic diag;
+    IdentifierPool idPool;
+    std::auto_ptr<AstResource> resource(new AstResource(idPool));
+    std::auto_ptr<AstResource> generation;
+    SourceItem *generationItem = 0;
+    std::auto_ptr<TextManager> manager(new TextManager());
+    SourceManager SM(idPool, diag);
+
+    bool failed = false;
+    for (;;) {
+        int client = accept(listener, 0, 0);
+        if (client < 0) {
+            if (errno == EINTR)
+                continue;
+            llvm::errs() << "Could not accept connection: "
+                         << std::strerror(errno) << '\n';
+            break;
+        }
+        int status = serveRequest(client, SM, resource, generation,
+                                  generationItem, manager, diag, failed);
+        failed = status != 0;
+        close(client);
+    }
+
+    close(listener);
+    unlink(addr.sun_path);
+    return 1;
+}
+
+// Sends a compilation request for the given path to a compile server and
+// relays its diagnostics.  Returns the exit status reported by the server.
+int runClient(llvm::sys::Path &path)
+{
+    sockaddr_un addr;
+    if (!getSocketAddress(ClientSocket, addr))
+        return 1;
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0 ||
+        connect(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr))) {
+        llvm::errs() << "Could not connect to `" << ClientSocket << "': "
+                     << std::strerror(errno) << '\n';
+        if (server >= 0)
+            close(server);
+        return 1;
+    }
+
+    // The server resolves paths relative to its own working directory.
+    std::string request = path.str();
+    if (request[0] != '/') {
+        llvm::sys::Path absolute = llvm::sys::Path::GetCurrentDirectory();
+        absolute.appendComponent(request);
+        request = absolute.str();
+    }
+    request.push_back('\n');
+
+    if (!writeAll(server, request.data(), request.size())) {
+        llvm::errs() << "Could not send request: "
+                     << std::strerror(errno) << '\n';
+        close(server);
+        return 1;
+    }
+
+    std::string response;
+    char buff[4096];
+    ssize_t count;
+    while ((count = read(server, buff, sizeof(buff))) != 0) {
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        response.append(buff, count);
+    }
+    close(server);
+
+    std::string::size_type pos = response.rfind('\0');
+    if (pos == std::string::npos) {
+        llvm::errs() << "Compile server closed the connection.\n";
+        return 1;
+    }
+
+    llvm::errs() << response.substr(0, pos);
+    return std::atoi(response.c_str() + pos + 1);
+}
+
 } // end anonymous namespace
 
 using namespace comma::driver;
@@ -441,32 +1373,43 @@ int main(int argc, char **argv)
 {
     llvm::cl::ParseCommandLineOptions(argc, argv);
 
+    if (DestDir.empty())
+        DestDir = llvm::sys::Path::GetCurrentDirectory().str();
+
+    // The level must be exactly one of 0, 1, 2, 3 or s.
+    if (OptLevel.size() != 1 ||
+        std::string("0123s").find(OptLevel[0]) == std::string::npos) {
+        llvm::errs() << "Invalid optimization level `-O" << OptLevel << "'.\n";
+        return 1;
+    }
+
+    if (!ServerSocket.empty())
+        return runServer();
+
     if (InputFile.empty()) {
         llvm::errs() << "Missing input file.\n";
         return 1;
     }
 
     llvm::sys::Path path(InputFile);
-    if (!path.canRead()) {
-        llvm::errs() << "Cannot open `" << path.str() <<"' for reading.\n";
+    if (!checkInputPath(path))
         return 1;
-    }
-    if (path.getSuffix() != "cms") {
-        llvm::errs() << "Input files must have a `.cms' extension.\n";
-        return 1;
-    }
 
-    if (DestDir.empty())
-        DestDir = llvm::sys::Path::GetCurrentDirectory().str();
+    if (!ClientSocket.empty())
+        return runClient(path);
 
     Diagnostic diag;
     IdentifierPool idPool;
     AstResource resource(idPool);
+    TextManager manager;
     SourceManager SM(idPool, diag);
     SourceItem *Item = SM.getSourceItem(path);
 
+    int status = 1;
     if (Item)
-        return compileSourceItem(Item, resource, diag) ? 0 : 1;
-    else
-        return 1;
+        status = compileSourceItem(Item, resource, resource, manager, diag);
+
+    if (PrintStats)
+        printStats(idPool, resource, manager);
+    return status;
 }